@@ -6,16 +6,44 @@ import sys
 import argparse
 from pathlib import Path
 
+def expand_delta(data, prev_nodes, prev_tick):
+    """Expand a delta state record against the cached previous full state.
+
+    Delta records (logging.delta_state) list only the nodes that changed;
+    an omitted node is the cached copy with last_hb advanced at tick rate
+    (the writer only omits a node when its heartbeat age is constant).
+    """
+    tick = data["tick"]
+    changed = {n["uid"]: n for n in data["nodes"]}
+    nodes = []
+    for uid, cached in prev_nodes.items():
+        if uid in changed:
+            nodes.append(changed[uid])
+        else:
+            node = dict(cached)
+            if node["last_hb"] >= 0:
+                node["last_hb"] += tick - prev_tick
+            nodes.append(node)
+    return {"tick": tick, "nodes": nodes}
+
+
 def load_states_and_metadata(path):
-    """Load state log and extract metadata."""
+    """Load state log and extract metadata, expanding delta records."""
     states = []
     metadata = {}
+    prev_nodes = {}
+    prev_tick = 0
     with open(path) as f:
         for line in f:
             data = json.loads(line)
             if "metadata" in data:
                 metadata = data
+                prev_nodes = {}
             else:
+                if data.get("delta"):
+                    data = expand_delta(data, prev_nodes, prev_tick)
+                prev_nodes = {n["uid"]: n for n in data["nodes"]}
+                prev_tick = data["tick"]
                 states.append(data)
     return states, metadata
 
@@ -105,6 +133,7 @@ def compute_metrics(states):
         sum(results["convergence_times"]) / len(results["convergence_times"])
         if results["convergence_times"] else 0
     )
+    results["max_convergence_time"] = max(results["convergence_times"], default=0)
 
     return results
 
@@ -119,6 +148,7 @@ def print_report(results):
     print("-" * 50)
     print(f"Agreement ratio:       {results['agreement_ratio']*100:.1f}%")
     print(f"Avg convergence time:  {results['avg_convergence_time']:.2f} ticks")
+    print(f"Max convergence time:  {results['max_convergence_time']} ticks")
     print(f"Convergence samples:   {len(results['convergence_times'])}")
     print("=" * 50)
 
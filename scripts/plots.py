@@ -350,7 +350,61 @@ def plot_scaling(results, output_path):
 
 
 # ============================================================
-# PLOT 5: Heatmap (p_fail vs p_drop)
+# PLOT 5: Performance Scaling (from -scale-sweep reports)
+# ============================================================
+def plot_perf_scaling(results, output_path):
+    """
+    Throughput and phase-time curves from a -scale-sweep report
+    (a result JSON containing a 'sweep' list).
+    """
+    points = []
+    for config, data in results.items():
+        points.extend(data.get('sweep', []))
+
+    if not points:
+        print("No -scale-sweep report found (need a JSON with a 'sweep' key)")
+        return
+
+    points.sort(key=lambda p: p['ranks'])
+    ranks = [p['ranks'] for p in points]
+    tps = [p['ticks_per_sec'] for p in points]
+
+    fig, axes = plt.subplots(1, 2, figsize=(12, 4.5))
+
+    ax = axes[0]
+    ax.plot(ranks, tps, 'o-', color='steelblue', linewidth=2, markersize=8)
+    ax.set_xlabel('Ranks')
+    ax.set_ylabel('Ticks per second')
+    ax.set_title('Simulation Throughput', fontweight='bold')
+    ax.set_xscale('log', base=2)
+    ax.set_yscale('log')
+    ax.grid(True, alpha=0.3)
+
+    # Per-phase total time across the sweep
+    ax = axes[1]
+    phase_names = sorted({name for p in points for name in p.get('phases', {})})
+    colors = plt.cm.viridis(np.linspace(0.1, 0.9, max(len(phase_names), 1)))
+    for name, color in zip(phase_names, colors):
+        totals = [p.get('phases', {}).get(name, {}).get('total_ms', 0)
+                  for p in points]
+        if max(totals) > 0:
+            ax.plot(ranks, totals, 'o-', label=name, color=color, linewidth=2)
+    ax.set_xlabel('Ranks')
+    ax.set_ylabel('Total time (ms, all ranks)')
+    ax.set_title('Phase Time', fontweight='bold')
+    ax.set_xscale('log', base=2)
+    ax.set_yscale('log')
+    ax.legend(loc='upper left', fontsize=8)
+    ax.grid(True, alpha=0.3)
+
+    plt.tight_layout()
+    plt.savefig(output_path, dpi=150, bbox_inches='tight')
+    plt.close()
+    print(f"Saved: {output_path}")
+
+
+# ============================================================
+# PLOT 6: Heatmap (p_fail vs p_drop)
 # ============================================================
 def plot_heatmap(results, metric, output_path):
     """
@@ -456,6 +510,8 @@ def generate_all(results, output_dir):
     
     # 4. Scaling
     plot_scaling(results, out / 'scaling.png')
+    if any('sweep' in d for d in results.values()):
+        plot_perf_scaling(results, out / 'perf_scaling.png')
     
     # 5. Heatmaps
     plot_heatmap(results, 'election_rate_per_100', out / 'heatmap_election.png')
@@ -486,7 +542,7 @@ Examples:
     parser.add_argument('results_dir', help='Directory with result JSON files')
     parser.add_argument('-o', '--output', default='plots', help='Output directory')
     parser.add_argument('-p', '--plot', 
-                        choices=['all', 'comparison', 'boxplot', 'histogram', 'scaling', 'heatmap'],
+                        choices=['all', 'comparison', 'boxplot', 'histogram', 'scaling', 'perf', 'heatmap'],
                         default='all', help='Plot type')
     parser.add_argument('-g', '--group-by',
                         choices=['num_nodes', 'p_fail', 'p_drop'],
@@ -530,6 +586,8 @@ Examples:
         plot_convergence_histogram(results, out / 'convergence_histogram.png', args.group_by)
     elif args.plot == 'scaling':
         plot_scaling(results, out / 'scaling.png')
+    elif args.plot == 'perf':
+        plot_perf_scaling(results, out / 'perf_scaling.png')
     elif args.plot == 'heatmap':
         plot_heatmap(results, args.metric, out / f'heatmap_{args.metric}.png')
     
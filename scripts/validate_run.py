@@ -115,12 +115,32 @@ class BullyValidator:
         self._load_message_log(message_log_path)
 
     def _load_state_log(self, path: str):
+        prev_nodes: Dict[int, dict] = {}
+        prev_tick = 0
         with open(path, 'r') as f:
             for line in f:
                 data = json.loads(line.strip())
                 if data.get('metadata'):
                     self.metadata = data
+                    prev_nodes = {}
                     continue
+                if data.get('delta'):
+                    # Delta records list only changed nodes; an omitted
+                    # node is the cached copy with last_hb advanced at
+                    # tick rate (see logging.delta_state)
+                    changed = {n['uid']: n for n in data['nodes']}
+                    nodes = []
+                    for uid, cached in prev_nodes.items():
+                        if uid in changed:
+                            nodes.append(changed[uid])
+                        else:
+                            node = dict(cached)
+                            if node['last_hb'] >= 0:
+                                node['last_hb'] += data['tick'] - prev_tick
+                            nodes.append(node)
+                    data = {'tick': data['tick'], 'nodes': nodes}
+                prev_nodes = {n['uid']: n for n in data['nodes']}
+                prev_tick = data['tick']
                 tick = data['tick']
                 self.states[tick] = [
                     NodeState(
@@ -507,9 +527,38 @@ class BullyValidator:
             is_critical=False
         )
 
+    def _fast_forward_ticks(self) -> set:
+        """Ticks elided by fast-forward windows: runs of hb_timeout or
+        more consecutive ticks with no message events at all. A real
+        run cannot stay that quiet - followers would time out and start
+        elections - so such runs can only be replayed window state."""
+        message_ticks = {m.tick for m in self.messages}
+        ff_ticks = set()
+        run = []
+        for tick in sorted(self.states.keys()):
+            if tick in message_ticks:
+                if len(run) >= self.hb_timeout:
+                    ff_ticks.update(run)
+                run = []
+            else:
+                run.append(tick)
+        if len(run) >= self.hb_timeout:
+            ff_ticks.update(run)
+        return ff_ticks
+
     def validate_r7_heartbeat_protocol(self) -> ValidationResult:
         """R7: Leader must send HEARTBEAT regularly."""
         violations = []
+        warnings = []
+
+        # Fast-forward windows log state rows but no messages; skip
+        # them rather than flagging elided heartbeats
+        ff_ticks = self._fast_forward_ticks()
+        if ff_ticks:
+            warnings.append(
+                f"Skipped {len(ff_ticks)} fast-forwarded ticks "
+                f"(state replayed, messages elided)"
+            )
 
         # Find consecutive ticks where a node is leader and online
         ticks = sorted(self.states.keys())
@@ -552,6 +601,8 @@ class BullyValidator:
                     continue  # Too short to meaningfully check
 
                 for tick in range(start + 1, end):
+                    if tick in ff_ticks:
+                        continue
                     hbs = [h for h in hb_by_tick.get(tick, []) if h.src == uid]
                     if not hbs:
                         # Check if heartbeat was sent recently
@@ -569,7 +620,8 @@ class BullyValidator:
         return ValidationResult(
             rule="R7: Heartbeat Protocol",
             passed=len(violations) == 0,
-            violations=violations
+            violations=violations,
+            warnings=warnings
         )
 
     def validate_r8_election_termination(self) -> ValidationResult:
@@ -0,0 +1,245 @@
+#include <mpi.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "node.hpp"
+#include "transport.hpp"
+#include "logger.hpp"
+#include "failure.hpp"
+
+// Microbenchmarks for the simulator's hot-path primitives, so hot-path
+// regressions show up as numbers instead of arguments. Run single-rank
+// for the serial primitives, or under mpirun to also measure the
+// per-tick collective round-trip at each rank count:
+//
+//   mpirun -np 8 ./bully_bench
+//
+// Rank 0 prints one JSON document: for every benchmark the median and
+// p99 per-operation cost over warm batches (5 warmup batches are
+// discarded), so the numbers are comparable across releases.
+
+using json = nlohmann::json;
+
+namespace {
+
+constexpr int WARMUP_BATCHES = 5;
+
+struct BenchResult {
+    double median_ns;
+    double p99_ns;
+    int batches;
+    long long ops_per_batch;
+};
+
+// Time `body` (one batch of `ops` operations) repeatedly and summarize
+// the per-op cost distribution over the timed batches
+template <typename F>
+BenchResult run_bench(int batches, long long ops, F&& body) {
+    std::vector<double> per_op_ns;
+    per_op_ns.reserve(batches);
+    for (int b = -WARMUP_BATCHES; b < batches; ++b) {
+        const double t0 = MPI_Wtime();
+        body();
+        const double dt = MPI_Wtime() - t0;
+        if (b >= 0) per_op_ns.push_back(dt * 1e9 / ops);
+    }
+    std::sort(per_op_ns.begin(), per_op_ns.end());
+    const int n = static_cast<int>(per_op_ns.size());
+    BenchResult r;
+    r.median_ns = per_op_ns[n / 2];
+    r.p99_ns = per_op_ns[std::min(n - 1, (99 * n) / 100)];
+    r.batches = batches;
+    r.ops_per_batch = ops;
+    return r;
+}
+
+json to_json(const BenchResult& r) {
+    return {{"median_ns", r.median_ns},
+            {"p99_ns", r.p99_ns},
+            {"batches", r.batches},
+            {"ops_per_batch", r.ops_per_batch}};
+}
+
+// Message-handling dispatch throughput: a steady mix of the message
+// types a node sees in a stable run (heartbeats and pings), delivered
+// through the in-process transport and drained with tick_recv so the
+// full receive path (take, log, dispatch) is measured
+json bench_handle_message() {
+    const int nodes = 8;
+    InprocRouter router(nodes + 1);
+    InprocTransport transport(router, 1);
+    NodeConfig cfg;
+    cfg.debug = false;
+    const long long ops = 20000;
+    cfg.max_recv_per_tick = static_cast<int>(ops);
+    Node node(1, nodes + 1, nodes, cfg, transport);
+
+    Message msgs[2] = {};
+    msgs[0].type = static_cast<int32_t>(MsgType::HEARTBEAT);
+    msgs[0].src_uid = nodes;
+    msgs[0].dst_uid = 1;
+    msgs[0].leader_uid = nodes;
+    msgs[1].type = static_cast<int32_t>(MsgType::PING);
+    msgs[1].src_uid = 2;
+    msgs[1].dst_uid = 1;
+    msgs[1].leader_uid = nodes;
+
+    auto r = run_bench(30, ops, [&]() {
+        for (long long i = 0; i < ops; ++i)
+            router.post(msgs[i & 1], 1);
+        node.tick_recv(0);
+        node.clear_message_buffer();
+        node.clear_debug_events();
+    });
+    return to_json(r);
+}
+
+json bench_add_event() {
+    MessageBuffer buf;
+    buf.reserve_for_nodes(8);
+    const long long ops = 100000;
+    auto r = run_bench(30, ops, [&]() {
+        for (long long i = 0; i < ops; ++i) {
+            buf.add_event(static_cast<int>(i), MsgType::PING, 1, 2, false,
+                          false);
+            if (buf.count() >= 1024) buf.clear();
+        }
+        buf.clear();
+    });
+    return to_json(r);
+}
+
+// Cost of one should_drop_outgoing-style uniform draw, for both RNG
+// modes (the private method is a p_drop compare around exactly this)
+json bench_rng_draw() {
+    std::mt19937_64 mt(mix_seed(12345, 1));
+    CounterRng crng(mix_seed(mix_seed(12345, 1), RNG_DOMAIN_NODE));
+    crng.set_tick(7);
+    std::uniform_real_distribution<double> uni(0.0, 1.0);
+
+    volatile double sink = 0.0;
+    const long long ops = 1000000;
+    auto mt_r = run_bench(30, ops, [&]() {
+        double acc = 0.0;
+        for (long long i = 0; i < ops; ++i) acc += uni(mt);
+        sink = acc;
+    });
+    auto crng_r = run_bench(30, ops, [&]() {
+        double acc = 0.0;
+        for (long long i = 0; i < ops; ++i) acc += uni(crng);
+        sink = acc;
+    });
+    (void)sink;
+    return {{"mt19937", to_json(mt_r)}, {"counter", to_json(crng_r)}};
+}
+
+// Logger write throughput per tick batch, for each on-disk format
+json bench_logger() {
+    const int nodes = 8;
+    TickLogBatch proto;
+    proto.states.resize(nodes);
+    for (int i = 0; i < nodes; ++i) {
+        proto.states[i].uid = i + 1;
+        proto.states[i].leader_uid = nodes;
+        proto.states[i].online = 1;
+    }
+    proto.messages.resize(4 * nodes);
+    for (size_t i = 0; i < proto.messages.size(); ++i) {
+        proto.messages[i].type = static_cast<int32_t>(MsgType::PING);
+        proto.messages[i].src_uid = static_cast<int32_t>(i % nodes) + 1;
+        proto.messages[i].dst_uid = static_cast<int32_t>((i + 1) % nodes) + 1;
+    }
+
+    json out;
+    for (const char* format : {"jsonl", "binary", "binary-mmap"}) {
+        Logger logger;
+        if (!logger.open("bench_state.tmp", "bench_msg.tmp", "", false,
+                         format)) {
+            std::cerr << "bully_bench: cannot open log files for " << format
+                      << "\n";
+            continue;
+        }
+        logger.log_metadata(nodes, 0, 12345);
+        const long long ops = 2000;
+        int tick = 0;
+        auto r = run_bench(20, ops, [&]() {
+            for (long long i = 0; i < ops; ++i) {
+                TickLogBatch batch = proto;
+                batch.tick = tick++;
+                logger.log_tick(std::move(batch));
+            }
+        });
+        logger.close();
+        out[format] = to_json(r);
+    }
+    std::remove("bench_state.tmp");
+    std::remove("bench_msg.tmp");
+    return out;
+}
+
+// Per-tick collective round-trip (barrier + small allreduce, the sync
+// skeleton of one simulated tick) at each power-of-two rank count up
+// to the launched world size
+json bench_collectives(int world_rank, int world_size) {
+    json out;
+    for (int size = 2; size <= world_size; size *= 2) {
+        MPI_Comm sub = MPI_COMM_NULL;
+        const int color = world_rank < size ? 0 : MPI_UNDEFINED;
+        MPI_Comm_split(MPI_COMM_WORLD, color, world_rank, &sub);
+
+        if (sub != MPI_COMM_NULL) {
+            const long long ops = 200;
+            auto r = run_bench(20, ops, [&]() {
+                for (long long i = 0; i < ops; ++i) {
+                    MPI_Barrier(sub);
+                    int local = 1, global = 0;
+                    MPI_Allreduce(&local, &global, 1, MPI_INT, MPI_MIN, sub);
+                }
+            });
+            if (world_rank == 0)
+                out["ranks_" + std::to_string(size)] = to_json(r);
+            MPI_Comm_free(&sub);
+        }
+        MPI_Barrier(MPI_COMM_WORLD);
+    }
+    return out;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    MPI_Init(&argc, &argv);
+    int rank = 0, world_size = 1;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &world_size);
+
+    json results;
+    if (rank == 0) {
+        results["handle_message"] = bench_handle_message();
+        results["message_buffer_add_event"] = bench_add_event();
+        results["rng_draw"] = bench_rng_draw();
+        results["logger_tick"] = bench_logger();
+    }
+    MPI_Barrier(MPI_COMM_WORLD);
+
+    json collectives = bench_collectives(rank, world_size);
+    if (rank == 0) {
+        if (world_size < 2)
+            results["collectives"] =
+                "launch under mpirun with 2+ ranks to measure";
+        else
+            results["collectives"] = collectives;
+
+        json j;
+        j["ranks"] = world_size;
+        j["benchmarks"] = results;
+        std::cout << j.dump(2) << "\n";
+    }
+
+    MPI_Finalize();
+    return 0;
+}
@@ -0,0 +1,114 @@
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Binary simulation snapshots for checkpoint/restart.
+//
+// Every checkpoint_interval ticks the controller collects each node's
+// serialized state (algorithm fields, RNG position, failure model
+// state, and any in-flight messages stashed from the transport) and
+// writes one snapshot file; a later run started with -restore <file>
+// resumes from the tick after the snapshot. The file is written to a
+// temp name and renamed so a preemption mid-write never corrupts the
+// previous checkpoint.
+//
+// File layout: CheckpointHeader, then num_nodes entries of
+//   int32 uid | int32 len | len blob bytes
+// Blob contents are produced and consumed by Node::save_state /
+// restore_state followed by Failure::save_state / restore_state; the
+// controller treats them as opaque.
+
+constexpr uint32_t CKPT_MAGIC = 0x4B435942;  // "BYCK"
+constexpr uint32_t CKPT_VERSION = 1;
+
+struct CheckpointHeader {
+    uint32_t magic;
+    uint32_t version;
+    int32_t tick;       // last completed tick
+    int32_t num_nodes;
+    uint64_t seed;
+};
+
+// POD stream helpers shared by the node and failure serializers
+template <typename T>
+inline void write_pod(std::ostream& out, const T& v) {
+    out.write(reinterpret_cast<const char*>(&v), sizeof(T));
+}
+
+template <typename T>
+inline void read_pod(std::istream& in, T& v) {
+    in.read(reinterpret_cast<char*>(&v), sizeof(T));
+}
+
+// Length-prefixed byte string (used for the textual mt19937 state)
+inline void write_blob_string(std::ostream& out, const std::string& s) {
+    uint32_t len = static_cast<uint32_t>(s.size());
+    write_pod(out, len);
+    out.write(s.data(), len);
+}
+
+inline std::string read_blob_string(std::istream& in) {
+    uint32_t len = 0;
+    read_pod(in, len);
+    std::string s(len, '\0');
+    in.read(&s[0], len);
+    return s;
+}
+
+inline bool write_checkpoint(const std::string& path,
+                             const CheckpointHeader& header,
+                             const std::vector<int>& uids,
+                             const std::vector<std::string>& blobs) {
+    std::string tmp = path + ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::binary);
+        if (!out.is_open()) return false;
+        write_pod(out, header);
+        for (size_t i = 0; i < uids.size(); ++i) {
+            write_pod(out, static_cast<int32_t>(uids[i]));
+            write_pod(out, static_cast<int32_t>(blobs[i].size()));
+            out.write(blobs[i].data(),
+                      static_cast<std::streamsize>(blobs[i].size()));
+        }
+        if (!out.good()) return false;
+    }
+    return std::rename(tmp.c_str(), path.c_str()) == 0;
+}
+
+inline bool read_checkpoint_header(const std::string& path,
+                                   CheckpointHeader& header) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in.is_open()) return false;
+    read_pod(in, header);
+    return in.good() && header.magic == CKPT_MAGIC &&
+           header.version == CKPT_VERSION;
+}
+
+// Extract one node's blob; every rank reads the shared checkpoint file
+// for its own entry, so no scatter step is needed
+inline bool read_checkpoint_blob(const std::string& path, int uid,
+                                 std::string& blob) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in.is_open()) return false;
+    CheckpointHeader header{};
+    read_pod(in, header);
+    if (!in.good() || header.magic != CKPT_MAGIC) return false;
+    for (int i = 0; i < header.num_nodes; ++i) {
+        int32_t entry_uid = 0, len = 0;
+        read_pod(in, entry_uid);
+        read_pod(in, len);
+        if (!in.good()) return false;
+        if (entry_uid == uid) {
+            blob.resize(len);
+            in.read(&blob[0], len);
+            return in.good();
+        }
+        in.seekg(len, std::ios::cur);
+    }
+    return false;
+}
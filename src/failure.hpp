@@ -1,8 +1,16 @@
 #pragma once
 #include <random>
 #include <vector>
+#include <deque>
 #include <cstdint>
 #include <memory>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <stdexcept>
+#include "checkpoint.hpp"
+#include "messages.hpp"
 
 // Seed mixing utility
 static inline uint64_t mix_seed(uint64_t base, uint64_t id) {
@@ -15,6 +23,42 @@ static inline uint64_t mix_seed(uint64_t base, uint64_t id) {
     return x;
 }
 
+// Counter-based random stream built on the same mixing function: each
+// value is mix_seed(mix_seed(key, tick), draw_index), so any tick's
+// draws are computable in O(1) without replaying earlier ticks and the
+// whole generator state is three words (vs ~2.5KB for mt19937_64).
+// That makes mid-run restart and fast-forward exact: skipped ticks
+// consume no state. Satisfies UniformRandomBitGenerator, so the std
+// distributions work unchanged. Call set_tick() once per tick before
+// drawing; selected with "rng": "counter" in the simulation section.
+class CounterRng {
+public:
+    using result_type = uint64_t;
+
+    explicit CounterRng(uint64_t key) : key_(key), tick_key_(mix_seed(key, 0)) {}
+
+    void set_tick(int tick) {
+        tick_key_ = mix_seed(key_, static_cast<uint64_t>(tick));
+        draw_ = 0;
+    }
+
+    result_type operator()() { return mix_seed(tick_key_, draw_++); }
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return UINT64_MAX; }
+
+private:
+    uint64_t key_;
+    uint64_t tick_key_;
+    uint64_t draw_ = 0;
+};
+
+// Domain tags keep the node and failure streams distinct even though
+// both are keyed on mix_seed(seed, uid)
+constexpr uint64_t RNG_DOMAIN_NODE = 0x4E0DEULL;
+constexpr uint64_t RNG_DOMAIN_FAILURE = 0xFA11ULL;
+constexpr uint64_t RNG_DOMAIN_PARTITION = 0x5917ULL;
+
 // Abstract base class for failure models
 // Extend this to implement different failure semantics
 class Failure {
@@ -27,12 +71,31 @@ public:
     // Whether the node can send/receive messages
     virtual bool can_communicate() const = 0;
 
+    // Per-destination reachability; node-scoped models treat the
+    // network as all-or-nothing, partition models override this
+    virtual bool can_send_to(int dst_uid) const {
+        (void)dst_uid;
+        return can_communicate();
+    }
+
     // For logging/visualization
     virtual bool is_failed() const { return !can_communicate(); }
     virtual int ticks_until_recovery() const { return 0; }
 
+    // Fast-forward support: how many of the next max_ticks ticks this
+    // node is guaranteed to stay online. Implementations may pre-draw
+    // randomness; subsequent tick() calls must consume those draws.
+    // Conservative default: never skip.
+    virtual int quiet_ticks_available(int max_ticks) { (void)max_ticks; return 0; }
+
     // Human-readable failure type for logs
     virtual const char* type_name() const = 0;
+
+    // Checkpoint/restart: serialize the model's mutable state (RNG
+    // position included) so a restored run continues bit-exactly.
+    // Stateless models have nothing to save.
+    virtual void save_state(std::ostream& out) const { (void)out; }
+    virtual void restore_state(std::istream& in) { (void)in; }
 };
 
 // Configuration for network failure model
@@ -41,6 +104,8 @@ struct NetworkFailureConfig {
     double leader_fail_multiplier = 2.0;
     std::vector<int> offline_durations{1, 2, 3, 5};
     std::vector<int> offline_weights{70, 20, 7, 3};
+    double p_split = 0.01;     // partition model: per-tick split probability
+    bool counter_rng = false;  // counter-based stream instead of mt19937
 };
 
 // Network failure: node runs but messages don't get through
@@ -51,23 +116,35 @@ public:
         : uid_(uid)
         , cfg_(cfg)
         , rng_(mix_seed(base_seed, static_cast<uint64_t>(uid)))
+        , crng_(mix_seed(mix_seed(base_seed, static_cast<uint64_t>(uid)),
+                         RNG_DOMAIN_FAILURE))
         , offline_dist_(cfg.offline_weights.begin(), cfg.offline_weights.end())
     {}
 
     void tick(int tick) override {
-        (void)tick;
+        next_tick_ = tick + 1;
 
         if (offline_remaining_ > 0) {
             offline_remaining_--;
+            // Cached draws assumed we were online - invalidate them
+            pending_.clear();
             return;
         }
 
-        double p = is_leader_ ? cfg_.p_fail * cfg_.leader_fail_multiplier 
-                              : cfg_.p_fail;
+        int duration;
+        if (cfg_.counter_rng) {
+            // Counter mode: this tick's decision is a pure function of
+            // (seed, uid, tick) - no cache, nothing to invalidate
+            duration = draw_failure_at(tick);
+        } else if (!pending_.empty()) {
+            duration = pending_.front();
+            pending_.pop_front();
+        } else {
+            duration = draw_failure();
+        }
 
-        if (uni_(rng_) < p) {
-            int idx = offline_dist_(rng_);
-            offline_remaining_ = cfg_.offline_durations[idx];
+        if (duration > 0) {
+            offline_remaining_ = duration;
         }
     }
 
@@ -75,6 +152,31 @@ public:
         return offline_remaining_ == 0;
     }
 
+    // Pre-draw the next max_ticks failure decisions and report how many
+    // consecutive ticks stay online; tick() consumes the cached draws
+    int quiet_ticks_available(int max_ticks) override {
+        if (offline_remaining_ > 0) return 0;
+        if (cfg_.counter_rng) {
+            // Evaluate upcoming ticks directly; tick() recomputes the
+            // same values, so no pre-draw cache is needed
+            int quiet = 0;
+            for (int i = 0; i < max_ticks; ++i) {
+                if (draw_failure_at(next_tick_ + i) != 0) break;
+                quiet++;
+            }
+            return quiet;
+        }
+        while (static_cast<int>(pending_.size()) < max_ticks) {
+            pending_.push_back(draw_failure());
+        }
+        int quiet = 0;
+        for (int i = 0; i < max_ticks; ++i) {
+            if (pending_[i] != 0) break;
+            quiet++;
+        }
+        return quiet;
+    }
+
     int ticks_until_recovery() const override {
         return offline_remaining_;
     }
@@ -83,20 +185,319 @@ public:
         return "NetworkFailure";
     }
 
+    void save_state(std::ostream& out) const override {
+        write_pod(out, static_cast<int32_t>(offline_remaining_));
+        write_pod(out, static_cast<int32_t>(next_tick_));
+        write_pod(out, static_cast<int32_t>(is_leader_ ? 1 : 0));
+        write_pod(out, static_cast<int32_t>(pending_.size()));
+        for (int d : pending_) write_pod(out, static_cast<int32_t>(d));
+        std::ostringstream rng;
+        rng << rng_;
+        write_blob_string(out, rng.str());
+    }
+
+    void restore_state(std::istream& in) override {
+        int32_t v = 0;
+        read_pod(in, v); offline_remaining_ = v;
+        read_pod(in, v); next_tick_ = v;
+        read_pod(in, v); is_leader_ = (v != 0);
+        int32_t count = 0;
+        read_pod(in, count);
+        pending_.clear();
+        for (int32_t i = 0; i < count; ++i) {
+            read_pod(in, v);
+            pending_.push_back(v);
+        }
+        std::istringstream rng(read_blob_string(in));
+        rng >> rng_;
+    }
+
     // Call this each tick before tick() if leader status affects failure rate
     void set_is_leader(bool is_leader) {
+        if (is_leader != is_leader_) {
+            // Failure probability changed - cached draws are stale
+            pending_.clear();
+        }
         is_leader_ = is_leader;
     }
 
 private:
+    // Draw one tick's failure decision: 0 = stays online, otherwise
+    // the offline duration in ticks
+    int draw_failure() {
+        double p = is_leader_ ? cfg_.p_fail * cfg_.leader_fail_multiplier
+                              : cfg_.p_fail;
+        if (uni_(rng_) < p) {
+            int idx = offline_dist_(rng_);
+            return cfg_.offline_durations[idx];
+        }
+        return 0;
+    }
+
+    // Counter-mode equivalent: the decision for tick t, computable out
+    // of order
+    int draw_failure_at(int t) {
+        double p = is_leader_ ? cfg_.p_fail * cfg_.leader_fail_multiplier
+                              : cfg_.p_fail;
+        crng_.set_tick(t);
+        if (uni_(crng_) < p) {
+            int idx = offline_dist_(crng_);
+            return cfg_.offline_durations[idx];
+        }
+        return 0;
+    }
+
     int uid_;
     NetworkFailureConfig cfg_;
     std::mt19937_64 rng_;
+    CounterRng crng_;
     std::discrete_distribution<int> offline_dist_;
     std::uniform_real_distribution<double> uni_{0.0, 1.0};
 
     int offline_remaining_ = 0;
+    int next_tick_ = 0;  // counter mode: first tick not yet decided
     bool is_leader_ = false;
+    std::deque<int> pending_;  // pre-drawn decisions for fast-forward
+};
+
+// Scheduled failure: replays per-node offline intervals from a trace
+// file instead of drawing fresh randomness. Sweeps comparing timeout
+// settings need identical failure timelines across configs - with
+// NetworkFailure, changing hb_timeout_ticks shifts the leader hint and
+// perturbs the whole draw sequence. Replaying a recorded schedule
+// gives common random numbers across the sweep, cutting the
+// replication count needed for the same confidence interval.
+//
+// File format (text, one interval per line, '#' comments):
+//   uid start_tick duration
+// Record a random run's schedule with failure.schedule_record (see
+// ScheduleRecorder below), then replay it with type "scheduled" and
+// failure.schedule_file.
+class ScheduledFailure : public Failure {
+public:
+    ScheduledFailure(int uid, const std::string& path) {
+        std::ifstream in(path);
+        if (!in.is_open())
+            throw std::runtime_error("cannot open failure schedule " + path);
+        std::string line;
+        while (std::getline(in, line)) {
+            if (line.empty() || line[0] == '#') continue;
+            std::istringstream ls(line);
+            int u = 0, start = 0, dur = 0;
+            if (!(ls >> u >> start >> dur)) continue;
+            if (u == uid && dur > 0)
+                intervals_.emplace_back(start, dur);
+        }
+        std::sort(intervals_.begin(), intervals_.end());
+    }
+
+    // Programmatic schedule: (start_tick, duration) intervals built in
+    // code instead of read from a trace (the stress workload generator)
+    explicit ScheduledFailure(std::vector<std::pair<int, int>> intervals)
+        : intervals_(std::move(intervals)) {
+        std::sort(intervals_.begin(), intervals_.end());
+    }
+
+    void tick(int tick) override {
+        next_tick_ = tick + 1;
+        // Derive the position from the tick itself rather than
+        // counting calls, so skipped ticks (fast-forward) are fine
+        while (idx_ < intervals_.size() &&
+               tick >= intervals_[idx_].first + intervals_[idx_].second)
+            ++idx_;
+        if (idx_ < intervals_.size() && tick >= intervals_[idx_].first)
+            remaining_ = intervals_[idx_].first + intervals_[idx_].second - tick;
+        else
+            remaining_ = 0;
+    }
+
+    bool can_communicate() const override { return remaining_ == 0; }
+    int ticks_until_recovery() const override { return remaining_; }
+
+    // The schedule is known in advance, so the quiet window is exact -
+    // no pre-draw cache needed
+    int quiet_ticks_available(int max_ticks) override {
+        if (remaining_ > 0) return 0;
+        size_t i = idx_;
+        while (i < intervals_.size() &&
+               next_tick_ >= intervals_[i].first + intervals_[i].second)
+            ++i;
+        if (i == intervals_.size()) return max_ticks;
+        int quiet = intervals_[i].first - next_tick_;
+        if (quiet < 0) quiet = 0;
+        return quiet < max_ticks ? quiet : max_ticks;
+    }
+
+    const char* type_name() const override { return "ScheduledFailure"; }
+
+    void save_state(std::ostream& out) const override {
+        write_pod(out, static_cast<int32_t>(idx_));
+        write_pod(out, static_cast<int32_t>(remaining_));
+        write_pod(out, static_cast<int32_t>(next_tick_));
+    }
+
+    void restore_state(std::istream& in) override {
+        int32_t v = 0;
+        read_pod(in, v); idx_ = v;
+        read_pod(in, v); remaining_ = v;
+        read_pod(in, v); next_tick_ = v;
+    }
+
+private:
+    std::vector<std::pair<int, int>> intervals_;  // (start, duration)
+    size_t idx_ = 0;
+    int remaining_ = 0;
+    int next_tick_ = 0;
+};
+
+// Records the offline intervals of a run as a schedule file that
+// ScheduledFailure can replay. Driven from the controller's gathered
+// state reports, so it works with every engine and failure model
+// without extra communication. Record with num_replications = 1;
+// replaying the same schedule across many replications is fine (and is
+// the point).
+class ScheduleRecorder {
+public:
+    void observe_tick(int tick, const std::vector<StateReport>& states) {
+        last_tick_ = tick;
+        for (const auto& s : states) {
+            if (static_cast<size_t>(s.uid) >= down_since_.size())
+                down_since_.resize(s.uid + 1, -1);
+            if (!s.online && down_since_[s.uid] < 0) {
+                down_since_[s.uid] = tick;
+            } else if (s.online && down_since_[s.uid] >= 0) {
+                intervals_.push_back({s.uid, down_since_[s.uid],
+                                      tick - down_since_[s.uid]});
+                down_since_[s.uid] = -1;
+            }
+        }
+    }
+
+    bool write(const std::string& path) const {
+        std::ofstream out(path);
+        if (!out.is_open()) return false;
+        out << "# bully failure schedule\n";
+        out << "# uid start_tick duration\n";
+        for (const auto& iv : intervals_)
+            out << iv.uid << " " << iv.start << " " << iv.duration << "\n";
+        // Intervals still open at the end of the run
+        for (size_t uid = 0; uid < down_since_.size(); ++uid) {
+            if (down_since_[uid] >= 0)
+                out << uid << " " << down_since_[uid] << " "
+                    << (last_tick_ + 1 - down_since_[uid]) << "\n";
+        }
+        return out.good();
+    }
+
+private:
+    struct Interval { int uid; int start; int duration; };
+    std::vector<Interval> intervals_;
+    std::vector<int> down_since_;
+    int last_tick_ = -1;
+};
+
+// Partition failure: the node set occasionally splits into two groups
+// that can talk internally but not across, the asymmetric-connectivity
+// case node-scoped models cannot express (split-brain leaders).
+//
+// Every instance evolves the same global partition: the RNG is keyed
+// on the base seed only (not the uid), and each instance consumes the
+// identical draw sequence per tick, so all nodes compute the same
+// splits with zero coordination traffic. Reachability is an n-bit map
+// (a few words even at n=256); can_send_to is one shift-and-AND, and
+// Node::send_message consults it per destination. The node itself
+// stays up (can_communicate() is always true) - only cross-partition
+// edges are cut. Split durations reuse offline_durations/weights.
+class PartitionFailure : public Failure {
+public:
+    PartitionFailure(int uid, int num_nodes, uint64_t base_seed,
+                     const NetworkFailureConfig& cfg)
+        : uid_(uid)
+        , num_nodes_(num_nodes)
+        , cfg_(cfg)
+        , rng_(mix_seed(base_seed, RNG_DOMAIN_PARTITION))
+        , dur_dist_(cfg.offline_weights.begin(), cfg.offline_weights.end())
+        , reach_(static_cast<size_t>(num_nodes / 64) + 1, ~0ULL)
+    {}
+
+    void tick(int tick) override {
+        (void)tick;
+        if (remaining_ > 0) {
+            if (--remaining_ == 0) heal();
+            return;
+        }
+        if (uni_(rng_) < cfg_.p_split) {
+            int idx = dur_dist_(rng_);
+            remaining_ = cfg_.offline_durations[idx];
+            open_split();
+        }
+    }
+
+    bool can_communicate() const override { return true; }
+
+    bool can_send_to(int dst_uid) const override {
+        return (reach_[dst_uid >> 6] >> (dst_uid & 63)) & 1ULL;
+    }
+
+    bool partitioned() const { return remaining_ > 0; }
+    int ticks_until_recovery() const override { return remaining_; }
+
+    const char* type_name() const override { return "PartitionFailure"; }
+
+    void save_state(std::ostream& out) const override {
+        write_pod(out, static_cast<int32_t>(remaining_));
+        write_pod(out, static_cast<int32_t>(reach_.size()));
+        for (uint64_t w : reach_) write_pod(out, w);
+        std::ostringstream rng;
+        rng << rng_;
+        write_blob_string(out, rng.str());
+    }
+
+    void restore_state(std::istream& in) override {
+        int32_t v = 0;
+        read_pod(in, v); remaining_ = v;
+        int32_t words = 0;
+        read_pod(in, words);
+        reach_.assign(words, 0ULL);
+        for (int32_t i = 0; i < words; ++i) read_pod(in, reach_[i]);
+        std::istringstream rng(read_blob_string(in));
+        rng >> rng_;
+    }
+
+private:
+    // Deal every node onto one of two sides; every instance draws the
+    // same sides, then keeps the bits for its own side
+    void open_split() {
+        std::vector<char> side(num_nodes_ + 1, 0);
+        int ones = 0;
+        for (int v = 1; v <= num_nodes_; ++v) {
+            side[v] = (rng_() & 1ULL) ? 1 : 0;
+            ones += side[v];
+        }
+        // Keep both sides nonempty so a split is always a real split
+        if (ones == 0) side[1] = 1;
+        else if (ones == num_nodes_) side[1] = 0;
+
+        std::fill(reach_.begin(), reach_.end(), 0ULL);
+        for (int v = 1; v <= num_nodes_; ++v) {
+            if (side[v] == side[uid_])
+                reach_[v >> 6] |= 1ULL << (v & 63);
+        }
+    }
+
+    void heal() {
+        std::fill(reach_.begin(), reach_.end(), ~0ULL);
+    }
+
+    int uid_;
+    int num_nodes_;
+    NetworkFailureConfig cfg_;
+    std::mt19937_64 rng_;
+    std::discrete_distribution<int> dur_dist_;
+    std::uniform_real_distribution<double> uni_{0.0, 1.0};
+
+    int remaining_ = 0;
+    std::vector<uint64_t> reach_;
 };
 
 // Crash failure: node fully stops (no internal logic runs)
@@ -127,7 +528,10 @@ public:
         return crashed_remaining_ == 0;
     }
 
-    // Crash failure also stops internal logic
+    // Crash failure also stops internal logic: the engines skip the
+    // crashed node's tick phases entirely (see run_worker_replication
+    // / run_inproc_replication) and call Node::recover when this flips
+    // back to false
     bool is_crashed() const {
         return crashed_remaining_ > 0;
     }
@@ -140,6 +544,20 @@ public:
         return "CrashFailure";
     }
 
+    void save_state(std::ostream& out) const override {
+        write_pod(out, static_cast<int32_t>(crashed_remaining_));
+        std::ostringstream rng;
+        rng << rng_;
+        write_blob_string(out, rng.str());
+    }
+
+    void restore_state(std::istream& in) override {
+        int32_t v = 0;
+        read_pod(in, v); crashed_remaining_ = v;
+        std::istringstream rng(read_blob_string(in));
+        rng >> rng_;
+    }
+
 private:
     int uid_;
     double p_crash_;
@@ -155,6 +573,7 @@ class NoFailure : public Failure {
 public:
     void tick(int tick) override { (void)tick; }
     bool can_communicate() const override { return true; }
+    int quiet_ticks_available(int max_ticks) override { return max_ticks; }
     const char* type_name() const override { return "NoFailure"; }
 };
 
@@ -162,7 +581,9 @@ public:
 enum class FailureType {
     None,
     Network,
-    Crash
+    Crash,
+    Partition,
+    Scheduled
 };
  
 inline std::unique_ptr<Failure> make_failure(
@@ -171,13 +592,19 @@ inline std::unique_ptr<Failure> make_failure(
     uint64_t seed,
     const NetworkFailureConfig& net_cfg = {},
     double crash_p = 0.02,
-    int crash_recovery = 3
+    int crash_recovery = 3,
+    int num_nodes = 0,
+    const std::string& schedule_file = ""
 ) {
     switch (type) {
         case FailureType::Network:
             return std::make_unique<NetworkFailure>(uid, seed, net_cfg);
         case FailureType::Crash:
             return std::make_unique<CrashFailure>(uid, seed, crash_p, crash_recovery);
+        case FailureType::Partition:
+            return std::make_unique<PartitionFailure>(uid, num_nodes, seed, net_cfg);
+        case FailureType::Scheduled:
+            return std::make_unique<ScheduledFailure>(uid, schedule_file);
         case FailureType::None:
         default:
             return std::make_unique<NoFailure>();
@@ -0,0 +1,115 @@
+// bully_log2jsonl - convert binary simulation logs back to JSONL.
+//
+// The simulator's binary log mode ("format": "binary" in the logging
+// config) writes raw StateReport/MessageEvent records for speed; this
+// tool replays them through the JSONL Logger so scripts/metrics.py and
+// the visualizer keep working unchanged.
+//
+// Usage:
+//   bully_log2jsonl -state state.bin -msg message.bin [-debug debug.bin]
+//                   [-out-state state_log.jsonl] [-out-msg message_log.jsonl]
+//                   [-out-debug debug_log.jsonl]
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "binlog.hpp"
+#include "logger.hpp"
+
+static std::string parse_string(int argc, char** argv, const std::string& key, const std::string& def) {
+    for (int i = 1; i < argc; ++i) {
+        if (key == argv[i] && i + 1 < argc) return argv[i + 1];
+    }
+    return def;
+}
+
+// Replays one binary log file into the Logger; returns records converted
+static int convert_file(const std::string& path, Logger& logger) {
+    BinLogReader reader;
+    if (!reader.open(path)) {
+        std::cerr << "Error: could not open binary log '" << path << "'\n";
+        return -1;
+    }
+
+    int records = 0;
+    RecordHeader header{};
+    std::vector<char> payload;
+
+    while (reader.next(header, payload)) {
+        switch (static_cast<RecordKind>(header.kind)) {
+        case RecordKind::Metadata: {
+            MetadataRecord meta{};
+            std::memcpy(&meta, payload.data(), sizeof(meta));
+            logger.log_metadata(meta.num_nodes, meta.num_ticks, meta.seed);
+            break;
+        }
+        case RecordKind::States: {
+            std::vector<StateReport> states(header.count);
+            std::memcpy(states.data(), payload.data(),
+                        header.count * sizeof(StateReport));
+            // All reports in a record share the tick
+            int tick = states.empty() ? 0 : states.front().tick;
+            logger.log_states(tick, states);
+            break;
+        }
+        case RecordKind::Messages: {
+            std::vector<MessageEvent> events(header.count);
+            std::memcpy(events.data(), payload.data(),
+                        header.count * sizeof(MessageEvent));
+            logger.log_messages(events);
+            break;
+        }
+        case RecordKind::Debug:
+            logger.log_debug(BinLogReader::decode_debug(header, payload));
+            break;
+        case RecordKind::Replication: {
+            ReplicationRecord rec{};
+            std::memcpy(&rec, payload.data(), sizeof(rec));
+            logger.log_replication(rec.replication, rec.seed);
+            break;
+        }
+        }
+        records++;
+    }
+    return records;
+}
+
+int main(int argc, char** argv) {
+    std::string state_in = parse_string(argc, argv, "-state", "");
+    std::string msg_in = parse_string(argc, argv, "-msg", "");
+    std::string debug_in = parse_string(argc, argv, "-debug", "");
+
+    std::string state_out = parse_string(argc, argv, "-out-state", "state_log.jsonl");
+    std::string msg_out = parse_string(argc, argv, "-out-msg", "message_log.jsonl");
+    std::string debug_out = parse_string(argc, argv, "-out-debug", "debug_log.jsonl");
+
+    if (state_in.empty() || msg_in.empty()) {
+        std::cerr << "Usage: bully_log2jsonl -state <state.bin> -msg <message.bin>"
+                     " [-debug <debug.bin>]\n"
+                     "       [-out-state <file>] [-out-msg <file>] [-out-debug <file>]\n";
+        return 1;
+    }
+
+    Logger logger;
+    if (!logger.open(state_out, msg_out, debug_in.empty() ? "" : debug_out)) {
+        std::cerr << "Error: could not open output files\n";
+        return 1;
+    }
+
+    int n = convert_file(state_in, logger);
+    if (n < 0) return 1;
+    std::cout << "Converted " << n << " state records -> " << state_out << "\n";
+
+    n = convert_file(msg_in, logger);
+    if (n < 0) return 1;
+    std::cout << "Converted " << n << " message records -> " << msg_out << "\n";
+
+    if (!debug_in.empty()) {
+        n = convert_file(debug_in, logger);
+        if (n < 0) return 1;
+        std::cout << "Converted " << n << " debug records -> " << debug_out << "\n";
+    }
+
+    logger.close();
+    return 0;
+}
@@ -3,78 +3,191 @@
 #include <vector>
 #include <string>
 #include <cstdint>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
 #include <nlohmann/json.hpp>
 #include "messages.hpp"
+#include "binlog.hpp"
+#include "stream.hpp"
 
 using json = nlohmann::json;
 
-// Maximum messages a node can buffer per tick for logging
-constexpr int MAX_MSG_EVENTS_PER_TICK = 32;
-
-// Event logged when a message is sent or received
-struct MessageEvent {
-    int32_t tick;
-    int32_t type;       // MsgType
-    int32_t src_uid;
-    int32_t dst_uid;    // -1 for broadcast
-    int32_t dropped;    // 0 = delivered, 1 = dropped
-    int32_t direction;  // 0 = sent, 1 = received
-    int32_t padding[2]; // Ensure 32-byte alignment
-};
+// Default per-tick message event capacity; buffers grow to fit the
+// node count via MessageBuffer::reserve_for_nodes
+constexpr int DEFAULT_MSG_EVENTS_PER_TICK = 32;
+
+// Everything the controller logs for one tick, bundled so it can be
+// handed to the async writer in one move
+struct TickLogBatch {
+    int tick = 0;
+    // When >= 0 this batch is a replication marker rather than tick
+    // data; queueing markers like any other batch keeps them ordered
+    // against the ticks around them in async mode
+    int replication = -1;
+    uint64_t replication_seed = 0;
+    std::vector<StateReport> states;
+    std::vector<MessageEvent> messages;
+    std::vector<DebugEntry> debug;
 
-// Helper to convert MsgType to string
-inline const char* msg_type_to_string(int32_t type) {
-    switch (static_cast<MsgType>(type)) {
-        case MsgType::HEARTBEAT:    return "HEARTBEAT";
-        case MsgType::ELECTION:     return "ELECTION";
-        case MsgType::OK:           return "OK";
-        case MsgType::COORDINATOR:  return "COORDINATOR";
-        case MsgType::PING:         return "PING";
-        case MsgType::ACK:          return "ACK";
-        case MsgType::STATE_REPORT: return "STATE_REPORT";
-        default:                    return "UNKNOWN";
-    }
-}
-
-// Debug message entry for logging
-struct DebugEntry {
-    int32_t tick;
-    int32_t uid;
-    std::string message;
+    // Empty the batch but keep the vector capacities, so a recycled
+    // batch refills without allocating
+    void clear() {
+        tick = 0;
+        replication = -1;
+        replication_seed = 0;
+        states.clear();
+        messages.clear();
+        debug.clear();
+    }
 };
 
 // Logger class for controller (rank 0)
 // Writes JSON Lines format for easy parsing
+//
+// In async mode a dedicated writer thread formats and writes batches
+// while the controller loop keeps simulating: the controller swaps the
+// gathered data into a back buffer via log_tick() and only blocks if
+// the writer is more than one full tick behind (double buffering).
 class Logger {
 public:
     Logger() = default;
+    ~Logger() { close(); }
 
+    // format: "jsonl" (default), "binary", or "binary-mmap" - binary
+    // writes the raw structs via BinLogWriter (convert with
+    // bully_log2jsonl afterwards); binary-mmap additionally routes the
+    // records through a memory-mapped file region instead of stream
+    // writes, removing the syscall-per-tick pattern
+    //
+    // Any empty path disables that log stream (e.g. sweep runs that
+    // only want metrics.json can pass "" for the message log)
     bool open(const std::string& state_path, const std::string& msg_path,
-              const std::string& debug_path = "") {
-        state_file_.open(state_path);
-        msg_file_.open(msg_path);
-        if (!debug_path.empty()) {
-            debug_file_.open(debug_path);
+              const std::string& debug_path = "", bool async = false,
+              const std::string& format = "jsonl") {
+        binary_ = (format == "binary" || format == "binary-mmap");
+        const bool use_mmap = (format == "binary-mmap");
+        if (binary_) {
+            if (!state_path.empty() && !bin_state_.open(state_path, use_mmap))
+                return false;
+            if (!msg_path.empty() && !bin_msg_.open(msg_path, use_mmap))
+                return false;
+            if (!debug_path.empty() && !bin_debug_.open(debug_path, use_mmap))
+                return false;
+        } else {
+            if (!state_path.empty()) {
+                state_file_.open(state_path);
+                if (!state_file_.is_open()) return false;
+            }
+            if (!msg_path.empty()) {
+                msg_file_.open(msg_path);
+                if (!msg_file_.is_open()) return false;
+            }
+            if (!debug_path.empty()) {
+                debug_file_.open(debug_path);
+                if (!debug_file_.is_open()) return false;
+            }
+        }
+
+        async_ = async;
+        if (async_) {
+            stop_ = false;
+            writer_ = std::thread(&Logger::writer_loop, this);
+        }
+        return true;
+    }
+
+    // Enable delta state records (jsonl only): ticks where a node's
+    // report is unchanged omit that node, writing
+    // {"tick":t,"delta":true,"nodes":[...changed only...]} instead of
+    // the full row; a full snapshot line is still written every
+    // `snapshot_interval` ticks so readers can seek without replaying
+    // the whole log. Binary formats always write full records.
+    void set_state_delta(int snapshot_interval) {
+        delta_interval_ = snapshot_interval > 0 ? snapshot_interval : 1;
+    }
+
+    // Publish each tick's batch over a localhost socket as well: a
+    // viewer (visualizer/serve.py --live) can attach at any point and
+    // receives length-prefixed frames of the same binary records the
+    // binary log format writes. Streamed records are always full state
+    // rows, independent of the on-disk format and delta settings.
+    bool enable_stream(int port) {
+        return stream_.open(port);
+    }
+
+    // Hand out a consumed batch with its buffer capacities intact; the
+    // caller fills it in place and passes it back through log_tick, so
+    // steady-state ticks construct no fresh vectors. Falls back to a
+    // default batch until the first few are recycled.
+    TickLogBatch acquire_batch() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (pool_.empty()) return TickLogBatch{};
+        TickLogBatch batch = std::move(pool_.back());
+        pool_.pop_back();
+        batch.clear();
+        return batch;
+    }
+
+    // Log a full tick: writes directly in sync mode, hands the batch to
+    // the writer thread in async mode
+    void log_tick(TickLogBatch&& batch) {
+        if (!async_) {
+            write_batch(batch);
+            recycle(std::move(batch));
+            return;
+        }
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            // Back-pressure: keep at most front + back buffer in flight
+            space_cv_.wait(lock, [this] { return pending_.size() < 2; });
+            pending_.push_back(std::move(batch));
         }
-        return state_file_.is_open() && msg_file_.is_open();
+        data_cv_.notify_one();
     }
 
     void close() {
+        if (async_) {
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                stop_ = true;
+            }
+            data_cv_.notify_one();
+            if (writer_.joinable()) writer_.join();
+            async_ = false;
+        }
         if (state_file_.is_open()) state_file_.close();
         if (msg_file_.is_open()) msg_file_.close();
         if (debug_file_.is_open()) debug_file_.close();
+        bin_state_.close();
+        bin_msg_.close();
+        bin_debug_.close();
+        stream_.close();
     }
 
     // Write state for all nodes at a given tick
     // Format: {"tick":0,"nodes":[{"uid":1,"online":true,"leader":5,"election":false,"last_hb":0},...]}\n
     void log_states(int tick, const std::vector<StateReport>& reports) {
+        if (binary_) {
+            if (bin_state_.is_open()) bin_state_.write_states(reports);
+            return;
+        }
         if (!state_file_.is_open()) return;
 
+        const bool delta = delta_interval_ > 0 &&
+                           prev_states_.size() == reports.size() &&
+                           tick % delta_interval_ != 0;
+
         json j;
         j["tick"] = tick;
+        if (delta) j["delta"] = true;
         j["nodes"] = json::array();
 
-        for (const auto& r : reports) {
+        for (size_t i = 0; i < reports.size(); ++i) {
+            const auto& r = reports[i];
+            if (delta && state_report_unchanged(prev_states_[i], r))
+                continue;
             j["nodes"].push_back({
                 {"uid", r.uid},
                 {"online", static_cast<bool>(r.online)},
@@ -84,6 +197,8 @@ public:
             });
         }
 
+        if (delta_interval_ > 0) prev_states_ = reports;
+
         state_file_ << j.dump() << "\n";
         state_file_.flush();
     }
@@ -91,6 +206,10 @@ public:
     // Write message events for a tick
     // Format: {"tick":5,"type":"ELECTION","src":3,"dst":5,"dropped":false,"dir":"send"}\n
     void log_messages(const std::vector<MessageEvent>& events) {
+        if (binary_) {
+            if (bin_msg_.is_open()) bin_msg_.write_messages(events);
+            return;
+        }
         if (!msg_file_.is_open()) return;
 
         for (const auto& e : events) {
@@ -109,6 +228,12 @@ public:
 
     // Write simulation metadata at start
     void log_metadata(int num_nodes, int num_ticks, uint64_t seed) {
+        stream_.set_metadata(num_nodes, num_ticks, seed);
+        if (binary_) {
+            if (bin_state_.is_open())
+                bin_state_.write_metadata(num_nodes, num_ticks, seed);
+            return;
+        }
         if (!state_file_.is_open()) return;
 
         json j = {
@@ -121,9 +246,30 @@ public:
         state_file_.flush();
     }
 
+    // Mark the start of a replication section in batch runs
+    // Format: {"metadata":true,"replication":2,"seed":98765}\n
+    //
+    // In async mode the marker travels through the writer queue as a
+    // special batch, so it lands after the previous replication's last
+    // tick and only the writer thread ever touches the output streams
+    void log_replication(int replication, uint64_t seed) {
+        if (!async_) {
+            write_replication_marker(replication, seed);
+            return;
+        }
+        TickLogBatch batch = acquire_batch();
+        batch.replication = replication;
+        batch.replication_seed = seed;
+        log_tick(std::move(batch));
+    }
+
     // Write debug messages for a tick
     // Format: {"tick":14,"uid":4,"msg":"GOING ONLINE (recovered) - passive, waiting for heartbeats"}\n
     void log_debug(const std::vector<DebugEntry>& entries) {
+        if (binary_) {
+            if (bin_debug_.is_open()) bin_debug_.write_debug(entries);
+            return;
+        }
         if (!debug_file_.is_open()) return;
 
         for (const auto& e : entries) {
@@ -138,34 +284,131 @@ public:
     }
 
 private:
+    void write_batch(const TickLogBatch& batch) {
+        if (batch.replication >= 0) {
+            write_replication_marker(batch.replication, batch.replication_seed);
+            return;
+        }
+        log_states(batch.tick, batch.states);
+        log_messages(batch.messages);
+        log_debug(batch.debug);
+        if (stream_.is_open())
+            stream_.publish(batch.states, batch.messages, batch.debug);
+    }
+
+    void write_replication_marker(int replication, uint64_t seed) {
+        stream_.publish_replication(replication, seed);
+        if (binary_) {
+            if (bin_state_.is_open())
+                bin_state_.write_replication(replication, seed);
+            return;
+        }
+        prev_states_.clear();  // next replication starts with a snapshot
+        if (!state_file_.is_open()) return;
+
+        json j = {
+            {"metadata", true},
+            {"replication", replication},
+            {"seed", seed}
+        };
+        state_file_ << j.dump() << "\n";
+        state_file_.flush();
+    }
+
+    void writer_loop() {
+        for (;;) {
+            TickLogBatch batch;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                data_cv_.wait(lock, [this] { return stop_ || !pending_.empty(); });
+                if (pending_.empty()) break;  // stop requested and drained
+                batch = std::move(pending_.front());
+                pending_.pop_front();
+            }
+            space_cv_.notify_one();
+            write_batch(batch);
+            recycle(std::move(batch));
+        }
+    }
+
+    // Keep a few written-out batches around for acquire_batch; the cap
+    // bounds idle memory (front + back buffer plus slack)
+    void recycle(TickLogBatch&& batch) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (pool_.size() < 4) pool_.push_back(std::move(batch));
+    }
+
     std::ofstream state_file_;
     std::ofstream msg_file_;
     std::ofstream debug_file_;
+
+    // Delta state records (0 = full records every tick)
+    int delta_interval_ = 0;
+    std::vector<StateReport> prev_states_;
+
+    // Recycled batches handed back out via acquire_batch
+    std::vector<TickLogBatch> pool_;
+
+    // Live streaming endpoint (enable_stream); published from
+    // write_batch, so in async mode only the writer thread touches it
+    StreamPublisher stream_;
+
+    // Binary mode writers
+    bool binary_ = false;
+    BinLogWriter bin_state_;
+    BinLogWriter bin_msg_;
+    BinLogWriter bin_debug_;
+
+    // Async writer state
+    bool async_ = false;
+    bool stop_ = false;
+    std::thread writer_;
+    std::mutex mutex_;
+    std::condition_variable data_cv_;   // signals the writer: batch ready
+    std::condition_variable space_cv_;  // signals the controller: buffer free
+    std::deque<TickLogBatch> pending_;
 };
 
 // Message buffer for nodes to collect events during a tick
 // Will be gathered by controller at end of tick
+//
+// Lossless: capacity is reserved once per run (sized from the node
+// count, since broadcasts log n-1 sends each) and clear() keeps it, so
+// the send path never allocates in steady state. Should a pathological
+// tick still exceed capacity, the vector grows instead of dropping
+// events.
 class MessageBuffer {
 public:
-    MessageBuffer() : count_(0) {}
+    MessageBuffer() {
+        events_.reserve(DEFAULT_MSG_EVENTS_PER_TICK);
+    }
+
+    // Size the buffer for a run with num_nodes nodes: enough for
+    // several broadcasts plus point-to-point traffic in one tick
+    void reserve_for_nodes(int num_nodes) {
+        size_t capacity = static_cast<size_t>(num_nodes) * 8 +
+                          DEFAULT_MSG_EVENTS_PER_TICK;
+        if (capacity > events_.capacity()) {
+            events_.reserve(capacity);
+        }
+    }
 
     void clear() {
-        count_ = 0;
+        events_.clear();  // keeps capacity
     }
 
     void add_event(int tick, MsgType type, int src_uid, int dst_uid,
                    bool dropped, bool is_recv) {
-        if (count_ >= MAX_MSG_EVENTS_PER_TICK) return;
-
-        events_[count_].tick = tick;
-        events_[count_].type = static_cast<int32_t>(type);
-        events_[count_].src_uid = src_uid;
-        events_[count_].dst_uid = dst_uid;
-        events_[count_].dropped = dropped ? 1 : 0;
-        events_[count_].direction = is_recv ? 1 : 0;
-        events_[count_].padding[0] = 0;
-        events_[count_].padding[1] = 0;
-        count_++;
+        MessageEvent e;
+        e.tick = tick;
+        e.type = static_cast<int32_t>(type);
+        e.src_uid = src_uid;
+        e.dst_uid = dst_uid;
+        e.dropped = dropped ? 1 : 0;
+        e.direction = is_recv ? 1 : 0;
+        e.padding[0] = 0;
+        e.padding[1] = 0;
+        events_.push_back(e);
     }
 
     void log_send(int tick, const Message& m, int dst_uid, bool dropped) {
@@ -176,11 +419,10 @@ public:
         add_event(tick, static_cast<MsgType>(m.type), m.src_uid, m.dst_uid, false, true);
     }
 
-    int count() const { return count_; }
-    const MessageEvent* data() const { return events_; }
-    MessageEvent* data() { return events_; }
+    int count() const { return static_cast<int>(events_.size()); }
+    const MessageEvent* data() const { return events_.data(); }
+    MessageEvent* data() { return events_.data(); }
 
 private:
-    MessageEvent events_[MAX_MSG_EVENTS_PER_TICK];
-    int count_;
+    std::vector<MessageEvent> events_;
 };
@@ -6,10 +6,16 @@
 #include <stdexcept>
 #include <vector>
 #include <numeric>
+#include <memory>
 #include <nlohmann/json.hpp>
 #include "node.hpp"
 #include "logger.hpp"
 #include "failure.hpp"
+#include "transport.hpp"
+#include "report.hpp"
+#include "metrics.hpp"
+#include "timing.hpp"
+#include "checkpoint.hpp"
 
 using json = nlohmann::json;
 
@@ -22,14 +28,52 @@ static std::string parse_string(int argc, char** argv, const std::string& key, c
 
 struct SimConfig {
     int num_ticks = 50;
+    int num_nodes = 5;        // inproc engine only; MPI engine infers from world size
     uint64_t seed = 12345;
+    int num_replications = 1;  // back-to-back simulations per launch
+    int num_groups = 1;        // parallel simulation groups (MPI engine)
+    bool fast_forward = false; // skip barriers/collectives on quiet ticks
+    int sync_interval = 8;     // max ticks to advance per quiet window
+    int checkpoint_interval = 0;  // snapshot every K ticks (0 = disabled)
+    std::string checkpoint_file = "checkpoint.bin";
+    std::string restore_file;  // set via -restore <file>
+    std::string engine = "mpi";     // "mpi" or "inproc"
+    std::string transport = "p2p";  // "p2p", "batched", or "shm" (MPI engine)
+    std::string rng = "mt19937";    // "mt19937" or "counter"
+    std::string uid_layout = "identity";  // "identity", "reverse", or explicit
+    std::vector<int> uid_assignment;      // explicit: UID for ranks 1..N in order
+
     NodeConfig node;
     NetworkFailureConfig failure;
     FailureType failure_type = FailureType::Network;
+    std::string schedule_file;      // scheduled model: trace to replay
+    std::string schedule_record;    // record this run's offline intervals
+
+    // Stress workload: scripted election storms (kill the top-K UIDs
+    // together, recover them together, optionally repeat) plus a
+    // background-traffic multiplier. Deterministic by construction -
+    // the worst case every run, no rare-event hunting.
+    bool stress = false;
+    int stress_top_k = 1;           // how many of the highest UIDs die
+    int stress_kill_tick = 10;      // tick of the first storm
+    int stress_down_ticks = 10;     // outage length per storm
+    int stress_repeat_every = 0;    // storm period (0 = single storm)
+    int stress_ping_multiplier = 1; // extra p_send draws per tick
+    double crash_p = 0.02;          // crash model: per-tick crash probability
+    int crash_recovery_ticks = 3;   // crash model: downtime per crash
+    bool crash_amnesia = true;      // crash model: lose state on recovery
     std::string state_log_file = "state_log.jsonl";
     std::string message_log_file = "message_log.jsonl";
     std::string debug_log_file = "debug_log.jsonl";
+    std::string metrics_file;  // streaming metrics output ("" = disabled)
+    std::string timing_file;   // phase timing summary ("" = disabled)
+    bool timing_per_tick = false;  // keep raw per-tick phase durations
+    bool delta_state = false;      // elide unchanged state reports/records
+    int state_snapshot_interval = 64;  // full snapshot every K ticks
     bool verbose = true;
+    bool log_async = false;  // write logs on a dedicated thread
+    std::string log_format = "jsonl";  // "jsonl", "binary", or "binary-mmap"
+    int stream_port = 0;     // live stream endpoint (0 = disabled)
 };
 
 SimConfig load_config(const std::string& path) {
@@ -44,11 +88,37 @@ SimConfig load_config(const std::string& path) {
     try {
         json j = json::parse(file);
 
+        // Engine selection: "mpi" (one process per node) or "inproc"
+        // (all nodes in one process, for fast parameter sweeps)
+        if (j.contains("engine")) config.engine = j["engine"];
+
+        // Transport selection: "p2p" (one MPI_Send per message),
+        // "batched" (per-tick MPI_Alltoallv exchange), or "shm"
+        // (shared-memory slot rings for co-located ranks)
+        if (j.contains("transport")) config.transport = j["transport"];
+
         // Simulation settings
         if (j.contains("simulation")) {
             auto& sim = j["simulation"];
             if (sim.contains("num_ticks")) config.num_ticks = sim["num_ticks"];
+            if (sim.contains("num_nodes")) config.num_nodes = sim["num_nodes"];
             if (sim.contains("seed")) config.seed = sim["seed"];
+            if (sim.contains("num_replications")) config.num_replications = sim["num_replications"];
+            if (sim.contains("num_groups")) config.num_groups = sim["num_groups"];
+            if (sim.contains("fast_forward")) config.fast_forward = sim["fast_forward"];
+            if (sim.contains("sync_interval")) config.sync_interval = sim["sync_interval"];
+            if (sim.contains("rng")) config.rng = sim["rng"];
+            if (sim.contains("checkpoint_interval")) config.checkpoint_interval = sim["checkpoint_interval"];
+            // UID assignment: "identity" (default), "reverse", or an
+            // explicit permutation of 1..N listing the UID per rank
+            if (sim.contains("uid_assignment")) {
+                if (sim["uid_assignment"].is_string()) {
+                    config.uid_layout = sim["uid_assignment"];
+                } else {
+                    config.uid_layout = "explicit";
+                    config.uid_assignment = sim["uid_assignment"].get<std::vector<int>>();
+                }
+            }
         }
 
         // Node settings (algorithm parameters only)
@@ -60,12 +130,15 @@ SimConfig load_config(const std::string& path) {
             if (node.contains("p_send")) config.node.p_send = node["p_send"];
             if (node.contains("p_drop")) config.node.p_drop = node["p_drop"];
             if (node.contains("max_recv_per_tick")) config.node.max_recv_per_tick = node["max_recv_per_tick"];
+            if (node.contains("delay_min_ticks")) config.node.delay_min_ticks = node["delay_min_ticks"];
+            if (node.contains("delay_max_ticks")) config.node.delay_max_ticks = node["delay_max_ticks"];
         }
 
         // Failure model settings (moved from node to separate config)
         if (j.contains("failure")) {
             auto& fail = j["failure"];
             if (fail.contains("p_fail")) config.failure.p_fail = fail["p_fail"];
+            if (fail.contains("p_split")) config.failure.p_split = fail["p_split"];
             if (fail.contains("leader_fail_multiplier")) config.failure.leader_fail_multiplier = fail["leader_fail_multiplier"];
             if (fail.contains("offline_durations")) config.failure.offline_durations = fail["offline_durations"].get<std::vector<int>>();
             if (fail.contains("offline_weights")) config.failure.offline_weights = fail["offline_weights"].get<std::vector<int>>();
@@ -74,10 +147,19 @@ SimConfig load_config(const std::string& path) {
                 if (type == "none") config.failure_type = FailureType::None;
                 else if (type == "network") config.failure_type = FailureType::Network;
                 else if (type == "crash") config.failure_type = FailureType::Crash;
+                else if (type == "partition") config.failure_type = FailureType::Partition;
+                else if (type == "scheduled") config.failure_type = FailureType::Scheduled;
             }
+            if (fail.contains("schedule_file")) config.schedule_file = fail["schedule_file"];
+            if (fail.contains("schedule_record")) config.schedule_record = fail["schedule_record"];
+            // Crash model parameters (p_crash falls back to p_fail)
+            if (fail.contains("p_crash")) config.crash_p = fail["p_crash"];
+            else if (fail.contains("p_fail")) config.crash_p = fail["p_fail"];
+            if (fail.contains("recovery_ticks")) config.crash_recovery_ticks = fail["recovery_ticks"];
+            if (fail.contains("recovery")) config.crash_amnesia = (fail["recovery"] != "persistent");
         }
         // Backwards compatibility: also read failure params from node section
-        else if (j.contains("node")) {
+        if (!j.contains("failure") && j.contains("node")) {
             auto& node = j["node"];
             if (node.contains("p_fail")) config.failure.p_fail = node["p_fail"];
             if (node.contains("leader_fail_multiplier")) config.failure.leader_fail_multiplier = node["leader_fail_multiplier"];
@@ -85,18 +167,57 @@ SimConfig load_config(const std::string& path) {
             if (node.contains("offline_weights")) config.failure.offline_weights = node["offline_weights"].get<std::vector<int>>();
         }
 
+        // Stress workload: presence of the section enables the mode
+        if (j.contains("stress")) {
+            auto& st = j["stress"];
+            config.stress = !st.contains("enabled") || st["enabled"].get<bool>();
+            if (st.contains("top_k")) config.stress_top_k = st["top_k"];
+            if (st.contains("kill_tick")) config.stress_kill_tick = st["kill_tick"];
+            if (st.contains("down_ticks")) config.stress_down_ticks = st["down_ticks"];
+            if (st.contains("repeat_every")) config.stress_repeat_every = st["repeat_every"];
+            if (st.contains("ping_multiplier")) config.stress_ping_multiplier = st["ping_multiplier"];
+        }
+
         // Logging settings
         if (j.contains("logging")) {
             auto& log = j["logging"];
             if (log.contains("state_log_file")) config.state_log_file = log["state_log_file"];
             if (log.contains("message_log_file")) config.message_log_file = log["message_log_file"];
             if (log.contains("debug_log_file")) config.debug_log_file = log["debug_log_file"];
+            if (log.contains("metrics_file")) config.metrics_file = log["metrics_file"];
+            if (log.contains("timing_file")) config.timing_file = log["timing_file"];
+            if (log.contains("timing_per_tick")) config.timing_per_tick = log["timing_per_tick"];
+            if (log.contains("delta_state")) config.delta_state = log["delta_state"];
+            if (log.contains("debug_categories")) {
+                uint32_t mask = 0;
+                for (const auto& cat : log["debug_categories"]) {
+                    std::string name = cat;
+                    if (name == "elections") mask |= DEBUG_ELECTIONS;
+                    else if (name == "heartbeats") mask |= DEBUG_HEARTBEATS;
+                    else if (name == "pings") mask |= DEBUG_PINGS;
+                    else if (name == "all") mask |= DEBUG_ALL;
+                    else std::cerr << "Warning: unknown debug category '" << name << "'\n";
+                }
+                config.node.debug_categories = mask;
+            }
+            // Clamped like Logger::set_state_delta so the worker-side
+            // snapshot modulus can never divide by zero
+            if (log.contains("snapshot_interval")) config.state_snapshot_interval = log["snapshot_interval"];
+            if (config.state_snapshot_interval < 1) config.state_snapshot_interval = 1;
+            if (log.contains("checkpoint_file")) config.checkpoint_file = log["checkpoint_file"];
             if (log.contains("verbose")) config.verbose = log["verbose"];
+            if (log.contains("async")) config.log_async = log["async"];
+            if (log.contains("format")) config.log_format = log["format"];
+            if (log.contains("stream_port")) config.stream_port = log["stream_port"];
         }
 
         // Apply seed to node config
         config.node.seed = config.seed;
+        if (config.stress)
+            config.node.ping_multiplier = config.stress_ping_multiplier;
         config.node.debug = config.verbose;
+        config.node.counter_rng = (config.rng == "counter");
+        config.failure.counter_rng = config.node.counter_rng;
 
     } catch (const json::exception& e) {
         std::cerr << "Error parsing config file: " << e.what() << "\n";
@@ -105,6 +226,85 @@ SimConfig load_config(const std::string& path) {
     return config;
 }
 
+// Per-group log file name: state_log.jsonl -> state_log.g2.jsonl
+// (unchanged when running a single group)
+static std::string group_log_path(const std::string &path, int group, int num_groups)
+{
+  if (num_groups <= 1 || path.empty())
+    return path;
+  std::string suffix = ".g" + std::to_string(group);
+  auto dot = path.rfind('.');
+  if (dot == std::string::npos)
+    return path + suffix;
+  return path.substr(0, dot) + suffix + path.substr(dot);
+}
+
+// Seed for replication rep: rep 0 keeps the configured seed so single
+// runs are unchanged; later replications derive fresh seeds via mix_seed
+static inline uint64_t replication_seed(uint64_t base, int rep)
+{
+  return rep == 0 ? base : mix_seed(base, 0x5EED0000ULL + static_cast<uint64_t>(rep));
+}
+
+// Build the rank <-> UID assignment for this run. "reverse" gives rank
+// r the UID N+1-r, placing the high-priority nodes (the ones that
+// answer every ELECTION) on the lowest ranks - typically the ones an
+// mpirun rankfile pins closest together.
+static UidMap make_uid_map(const SimConfig &sim_config, int nodes)
+{
+  if (sim_config.uid_layout == "explicit")
+  {
+    if (static_cast<int>(sim_config.uid_assignment.size()) != nodes)
+      throw std::runtime_error("uid_assignment lists " +
+                               std::to_string(sim_config.uid_assignment.size()) +
+                               " UIDs for " + std::to_string(nodes) + " nodes");
+    return UidMap(sim_config.uid_assignment);
+  }
+  if (sim_config.uid_layout == "reverse")
+  {
+    std::vector<int> uids(nodes);
+    for (int r = 1; r <= nodes; ++r)
+      uids[r - 1] = nodes + 1 - r;
+    return UidMap(uids);
+  }
+  if (sim_config.uid_layout != "identity")
+    throw std::runtime_error("unknown uid_assignment '" + sim_config.uid_layout + "'");
+  return UidMap();
+}
+
+// Offline intervals for `uid` under the stress workload: the top-K
+// UIDs die together at kill_tick and, with repeat_every > 0, every
+// storm period after - simultaneous leader death plus mass recovery,
+// the worst case for election fan-out
+static std::vector<std::pair<int, int>> stress_intervals(const SimConfig &sim_config,
+                                                         int uid, int nodes)
+{
+  std::vector<std::pair<int, int>> intervals;
+  if (uid <= nodes - sim_config.stress_top_k)
+    return intervals;
+  for (int start = sim_config.stress_kill_tick; start < sim_config.num_ticks;
+       start += sim_config.stress_repeat_every)
+  {
+    intervals.emplace_back(start, sim_config.stress_down_ticks);
+    if (sim_config.stress_repeat_every <= 0)
+      break;
+  }
+  return intervals;
+}
+
+// Failure model factory honoring the stress workload: stress runs get
+// a programmatic ScheduledFailure, everything else goes through the
+// regular make_failure path
+static std::unique_ptr<Failure> make_sim_failure(const SimConfig &sim_config,
+                                                 int uid, uint64_t seed, int nodes)
+{
+  if (sim_config.stress)
+    return std::make_unique<ScheduledFailure>(stress_intervals(sim_config, uid, nodes));
+  return make_failure(sim_config.failure_type, uid, seed, sim_config.failure,
+                      sim_config.crash_p, sim_config.crash_recovery_ticks,
+                      nodes, sim_config.schedule_file);
+}
+
 struct MpiEnv
 {
   MpiEnv(int &argc, char **&argv)
@@ -147,6 +347,776 @@ inline std::string rank_prefix(int rank, int size)
   return oss.str();
 }
 
+// One replication of the controller loop: gather every worker's packed
+// report each tick and hand it to the logger
+//
+// Reporting is pipelined one tick deep with nonblocking collectives:
+// tick t's MPI_Igatherv drains while tick t-1's data is unpacked and
+// logged, and workers are already computing tick t+1. The old per-tick
+// sim_comm barrier is gone - the matching order of the gather
+// collectives bounds how far workers can run ahead.
+//
+// Fast-forward mode: each round starts with an MPI_Allreduce(MIN) of
+// quiet-window proposals. When every node can advance locally (stable
+// leader, no elections, guaranteed online), the window is skipped
+// without gathers and the controller replays its cached state for the
+// skipped ticks so the state log stays complete.
+static void run_controller_replication(Logger &logger, MetricsEngine &metrics,
+                                       ScheduleRecorder &recorder,
+                                       TimingEngine &timing, MPI_Comm sim_comm,
+                                       int world_size, int nodes, int ticks,
+                                       const SimConfig &sim_config)
+{
+  std::vector<StateReport> last_states;
+  const UidMap uid_map = make_uid_map(sim_config, nodes);
+
+  // Per-rank cache of the last full report each worker shipped; with
+  // delta_state an unchanged marker (has_state = 0) is expanded from
+  // here. Workers always ship a full report on their first tick, so
+  // the cache is warm before the first marker can arrive.
+  std::vector<StateReport> cached_reports(world_size);
+
+  // Double-buffered pipeline state, indexed by tick parity
+  std::vector<char> report_data[2];
+  std::vector<int> report_sizes[2] = {std::vector<int>(world_size),
+                                      std::vector<int>(world_size)};
+  std::vector<int> report_displs[2] = {std::vector<int>(world_size),
+                                       std::vector<int>(world_size)};
+  MPI_Request data_req[2] = {MPI_REQUEST_NULL, MPI_REQUEST_NULL};
+  int pending_tick = -1;
+
+  // Per-rank debug events from the current report, reused across ticks
+  std::vector<DebugEvent> debug_scratch;
+
+  // Finish the in-flight gather, then unpack and log its tick. The
+  // batch and scratch vectors are recycled, so once capacities reach
+  // their high-water mark a steady-state tick allocates nothing here
+  // (jsonl formatting and debug-entry strings still allocate; the
+  // binary formats avoid both).
+  auto flush_pending = [&]() {
+    if (pending_tick < 0)
+      return;
+    const int slot = pending_tick % 2;
+    double tm = timing.now();
+    MPI_Wait(&data_req[slot], MPI_STATUS_IGNORE);
+    timing.record(TIMING_GATHER, tm);
+
+    TickLogBatch batch = logger.acquire_batch();
+    batch.tick = pending_tick;
+    batch.states.reserve(nodes);
+
+    for (int i = 1; i < world_size; ++i) {  // Skip rank 0
+      StateReport s{};
+      debug_scratch.clear();
+      if (!unpack_report_into(report_data[slot].data() + report_displs[slot][i],
+                              s, batch.messages, debug_scratch))
+        s = advance_state_report(cached_reports[i], pending_tick);
+      cached_reports[i] = s;
+      batch.states.push_back(s);
+
+      for (const auto& e : debug_scratch) {
+        DebugEntry entry;
+        entry.tick = e.tick;
+        entry.uid = uid_map.uid_of(i);
+        entry.message = render_debug_event(e);
+        batch.debug.push_back(std::move(entry));
+      }
+    }
+
+    // Keep a copy for fast-forward state replay (assignment reuses the
+    // destination's capacity)
+    last_states = batch.states;
+
+    metrics.observe_tick(pending_tick, batch.states, batch.messages);
+    recorder.observe_tick(pending_tick, batch.states);
+
+    tm = timing.now();
+    logger.log_tick(std::move(batch));
+    timing.record(TIMING_LOG, tm);
+    pending_tick = -1;
+  };
+
+  int t = 0;
+  if (!sim_config.restore_file.empty())
+  {
+    CheckpointHeader h{};
+    if (!read_checkpoint_header(sim_config.restore_file, h))
+      throw std::runtime_error("cannot read checkpoint " + sim_config.restore_file);
+    if (h.num_nodes != nodes || h.seed != sim_config.seed)
+      throw std::runtime_error("checkpoint does not match this configuration");
+    t = h.tick + 1;
+  }
+  while (t < ticks)
+  {
+    if (sim_config.fast_forward)
+    {
+      // Propose the full window once we have cached state to replay
+      int proposal = last_states.empty() ? 0 : sim_config.sync_interval;
+      int window = 0;
+      double tm = timing.now();
+      MPI_Allreduce(&proposal, &window, 1, MPI_INT, MPI_MIN, sim_comm);
+      timing.record(TIMING_FF_SYNC, tm);
+      if (window > ticks - t) window = ticks - t;
+
+      if (window > 0)
+      {
+        // Drain the pipeline first so the log stays in tick order
+        flush_pending();
+        for (int k = 0; k < window; ++k, ++t)
+        {
+          // Workers advance last_hb in lockstep with the tick during
+          // the window, so reconstruct rows the same way instead of
+          // freezing heartbeat age at the pre-window value
+          for (auto &s : last_states) s = advance_state_report(s, t);
+          metrics.observe_tick(t, last_states, {});
+          recorder.observe_tick(t, last_states);
+          TickLogBatch batch = logger.acquire_batch();
+          batch.tick = t;
+          batch.states = last_states;
+          logger.log_tick(std::move(batch));
+        }
+        continue;
+      }
+    }
+
+    const int slot = t % 2;
+    timing.begin_tick(t);
+
+    // Gather packed report sizes (one int per rank; controller is 0)
+    int zero = 0;
+    MPI_Request size_req;
+    double tm = timing.now();
+    MPI_Igather(&zero, 1, MPI_INT,
+                report_sizes[slot].data(), 1, MPI_INT,
+                0, sim_comm, &size_req);
+    MPI_Wait(&size_req, MPI_STATUS_IGNORE);
+    timing.record(TIMING_GATHER, tm);
+
+    int total_bytes = 0;
+    for (int i = 0; i < world_size; ++i) {
+      report_displs[slot][i] = total_bytes;
+      total_bytes += report_sizes[slot][i];
+    }
+
+    // Post the data gather nonblockingly; it drains while we unpack
+    // and log the previous tick below
+    report_data[slot].resize(total_bytes > 0 ? total_bytes : 1);
+    MPI_Igatherv(nullptr, 0, MPI_BYTE,
+                 report_data[slot].data(), report_sizes[slot].data(),
+                 report_displs[slot].data(), MPI_BYTE,
+                 0, sim_comm, &data_req[slot]);
+
+    flush_pending();
+    pending_tick = t;
+
+    // Periodic checkpoint: gather every worker's snapshot blob and
+    // write one atomic file (blocking collectives; checkpoints are
+    // rare compared to ticks)
+    if (sim_config.checkpoint_interval > 0 &&
+        (t + 1) % sim_config.checkpoint_interval == 0)
+    {
+      tm = timing.now();
+      std::vector<int> ck_sizes(world_size);
+      int zero = 0;
+      MPI_Gather(&zero, 1, MPI_INT, ck_sizes.data(), 1, MPI_INT, 0, sim_comm);
+
+      std::vector<int> ck_displs(world_size);
+      int ck_total = 0;
+      for (int i = 0; i < world_size; ++i) {
+        ck_displs[i] = ck_total;
+        ck_total += ck_sizes[i];
+      }
+      std::vector<char> ck_data(ck_total > 0 ? ck_total : 1);
+      MPI_Gatherv(nullptr, 0, MPI_BYTE,
+                  ck_data.data(), ck_sizes.data(), ck_displs.data(), MPI_BYTE,
+                  0, sim_comm);
+
+      std::vector<int> uids;
+      std::vector<std::string> blobs;
+      for (int i = 1; i < world_size; ++i) {
+        uids.push_back(i);
+        blobs.emplace_back(ck_data.data() + ck_displs[i], ck_sizes[i]);
+      }
+      CheckpointHeader h{CKPT_MAGIC, CKPT_VERSION, t, nodes, sim_config.seed};
+      if (!write_checkpoint(sim_config.checkpoint_file, h, uids, blobs))
+        std::cerr << "[Controller] Failed to write checkpoint "
+                  << sim_config.checkpoint_file << "\n";
+      timing.record(TIMING_CHECKPOINT, tm);
+    }
+    ++t;
+  }
+
+  // Drain the last tick still in flight
+  flush_pending();
+}
+
+// One replication of the worker loop: run the node's tick phases and
+// ship the packed report to the controller each tick
+//
+// Reports are posted with MPI_Igather/MPI_Igatherv and the worker moves
+// straight into the next tick's phases; each of the two packed buffers
+// is only reused once its gathers from two ticks back have completed,
+// so the controller's gather+log latency stays off the critical path.
+static void run_worker_replication(int rank, MPI_Comm sim_comm, int world_size,
+                                   int nodes, int ticks, const NodeConfig &cfg,
+                                   const SimConfig &sim_config,
+                                   uint64_t seed, Transport &transport,
+                                   BatchedMpiTransport *batched,
+                                   MPI_Comm worker_comm, ReportPacker *packers,
+                                   TimingEngine &timing)
+{
+  const UidMap uid_map = make_uid_map(sim_config, nodes);
+  const int uid = uid_map.uid_of(rank);
+  Node node(rank, world_size, nodes, cfg, transport, &uid_map);
+
+  // Per-slot outstanding requests: [0] = size gather, [1] = data gather
+  int report_size[2] = {0, 0};
+  MPI_Request reqs[2][2] = {{MPI_REQUEST_NULL, MPI_REQUEST_NULL},
+                            {MPI_REQUEST_NULL, MPI_REQUEST_NULL}};
+
+  // Create failure model for this node (keyed by UID so failure
+  // behavior follows election priority, not placement)
+  auto failure = make_sim_failure(sim_config, uid, seed, nodes);
+  node.set_failure_view(failure.get());
+  auto *crash = dynamic_cast<CrashFailure *>(failure.get());
+  bool was_crashed = false;
+
+  // Delta state reporting: last report actually shipped in full, so an
+  // unchanged marker is always relative to what the controller cached
+  StateReport prev_report{};
+  bool have_prev = false;
+
+  int t = 0;
+  if (!sim_config.restore_file.empty())
+  {
+    CheckpointHeader h{};
+    std::string blob;
+    if (!read_checkpoint_header(sim_config.restore_file, h) ||
+        h.num_nodes != nodes || h.seed != seed ||
+        !read_checkpoint_blob(sim_config.restore_file, rank, blob))
+      throw std::runtime_error("cannot restore rank " + std::to_string(rank) +
+                               " from " + sim_config.restore_file);
+    std::istringstream in(blob);
+    node.restore_state(in);
+    failure->restore_state(in);
+    t = h.tick + 1;
+  }
+  while (t < ticks)
+  {
+    if (sim_config.fast_forward)
+    {
+      // Propose how far we could advance without synchronizing; the
+      // MIN reduce picks the window every node (and the controller,
+      // which proposes the full interval) can honor
+      int proposal = 0;
+      if (node.is_quiescent(t))
+        proposal = failure->quiet_ticks_available(sim_config.sync_interval);
+      int window = 0;
+      double tm = timing.now();
+      MPI_Allreduce(&proposal, &window, 1, MPI_INT, MPI_MIN, sim_comm);
+      timing.record(TIMING_FF_SYNC, tm);
+      if (window > ticks - t) window = ticks - t;
+
+      if (window > 0)
+      {
+        // Advance bookkeeping locally: no sends, receives, or reports.
+        // Background pings and heartbeat messages are elided for the
+        // window; the heartbeat freshness they would provide is applied
+        // via fast_forward_tick.
+        for (int k = 0; k < window; ++k, ++t)
+        {
+          failure->tick(t);
+          node.fast_forward_tick(t);
+        }
+        continue;
+      }
+    }
+
+    timing.begin_tick(t);
+    double tm = timing.now();
+    MPI_Barrier(worker_comm);
+    timing.record(TIMING_BARRIER, tm);
+
+    // Update failure state for this tick
+    if (auto* net_fail = dynamic_cast<NetworkFailure*>(failure.get())) {
+      net_fail->set_is_leader(node.leader_uid() == node.uid());
+    }
+    failure->tick(t);
+
+    // Inject communication status into node
+    node.set_can_communicate(failure->can_communicate());
+
+    // Crash semantics: a crashed node runs no logic at all - timers
+    // frozen, nothing sent, anything delivered meanwhile lost. On the
+    // first tick back, recover() applies the configured recovery mode
+    const bool crashed = crash && crash->is_crashed();
+    if (was_crashed && !crashed)
+      node.recover(t, sim_config.crash_amnesia);
+    was_crashed = crashed;
+
+    if (crashed)
+    {
+      if (batched)
+      {
+        tm = timing.now();
+        batched->exchange();  // collective: crashed ranks still take part
+        timing.record(TIMING_EXCHANGE, tm);
+      }
+      node.purge_incoming();
+    }
+    else
+    {
+      tm = timing.now();
+      node.tick_begin(t);
+      timing.record(TIMING_TICK_BEGIN, tm);
+      tm = timing.now();
+      node.tick_send(t);
+      timing.record(TIMING_TICK_SEND, tm);
+      if (batched)
+      {
+        tm = timing.now();
+        batched->exchange();  // collective across all workers
+        timing.record(TIMING_EXCHANGE, tm);
+      }
+      tm = timing.now();
+      node.tick_recv(t);
+      timing.record(TIMING_TICK_RECV, tm);
+      tm = timing.now();
+      node.tick_end(t);
+      timing.record(TIMING_TICK_END, tm);
+    }
+
+    tm = timing.now();
+    MPI_Barrier(worker_comm);
+    timing.record(TIMING_BARRIER, tm);
+
+    // Reusing this slot's buffer requires its previous gathers done
+    const int slot = t % 2;
+    tm = timing.now();
+    MPI_Waitall(2, reqs[slot], MPI_STATUSES_IGNORE);
+
+    // Pack state + message events + debug events into one buffer
+    StateReport report = node.make_state_report(t);
+    bool ship_state = true;
+    if (sim_config.delta_state)
+    {
+      // Resend a full report every snapshot interval so a marker is
+      // never more than K ticks from the state it was drawn against
+      ship_state = !have_prev || !state_report_unchanged(prev_report, report) ||
+                   t % sim_config.state_snapshot_interval == 0;
+    }
+    prev_report = report;
+    have_prev = true;
+    packers[slot].pack(report, ship_state, node.message_buffer().data(),
+                       node.message_buffer().count(),
+                       node.debug_events().data(),
+                       static_cast<int>(node.debug_events().size()));
+
+    // Post the report and proceed straight into the next tick
+    report_size[slot] = packers[slot].size();
+    MPI_Igather(&report_size[slot], 1, MPI_INT,
+                nullptr, 0, MPI_INT,
+                0, sim_comm, &reqs[slot][0]);
+
+    MPI_Igatherv(packers[slot].data(), report_size[slot], MPI_BYTE,
+                 nullptr, nullptr, nullptr, MPI_BYTE,
+                 0, sim_comm, &reqs[slot][1]);
+    timing.record(TIMING_REPORT, tm);
+
+    // Clear buffers for next tick
+    node.clear_message_buffer();
+    node.clear_debug_events();
+
+    // Periodic checkpoint: stash in-flight messages so they land in
+    // the snapshot (the stash is redelivered first next tick, so the
+    // continuing run is unaffected), then ship the blob to the
+    // controller
+    if (sim_config.checkpoint_interval > 0 &&
+        (t + 1) % sim_config.checkpoint_interval == 0)
+    {
+      tm = timing.now();
+      if (batched) {
+        // Replies from this tick's recv phase are still sitting in the
+        // outboxes; flush them so the stash captures everything
+        batched->exchange();
+        node.stash_incoming();
+      } else {
+        // Quiescence by message counting: keep draining until every
+        // transport send has been received or stashed somewhere, so a
+        // message still in MPI flight cannot be lost from the snapshot
+        for (;;) {
+          node.stash_incoming();
+          long long local[2] = {node.transport_sent(),
+                                node.transport_received()};
+          long long global[2] = {0, 0};
+          MPI_Allreduce(local, global, 2, MPI_LONG_LONG, MPI_SUM,
+                        worker_comm);
+          if (global[0] == global[1]) break;
+        }
+      }
+      std::ostringstream blob;
+      node.save_state(blob);
+      failure->save_state(blob);
+      const std::string bytes = blob.str();
+      int len = static_cast<int>(bytes.size());
+      MPI_Gather(&len, 1, MPI_INT, nullptr, 0, MPI_INT, 0, sim_comm);
+      MPI_Gatherv(bytes.data(), len, MPI_BYTE,
+                  nullptr, nullptr, nullptr, MPI_BYTE, 0, sim_comm);
+      timing.record(TIMING_CHECKPOINT, tm);
+    }
+    ++t;
+  }
+
+  // Drain outstanding reports before the replication ends
+  MPI_Waitall(2, reqs[0], MPI_STATUSES_IGNORE);
+  MPI_Waitall(2, reqs[1], MPI_STATUSES_IGNORE);
+}
+
+// In-process engine: all nodes live in this process and exchange
+// messages through InprocRouter queues. Runs the same tick phases as
+// the MPI engine, but as sequential loops over the node set - all
+// sends for a tick complete before any node drains its inbox, which
+// matches the barrier-synchronized MPI delivery model.
+static void run_inproc_replication(Logger &logger, MetricsEngine &metrics,
+                                   ScheduleRecorder &recorder,
+                                   TimingEngine &timing,
+                                   const SimConfig &sim_config, uint64_t seed)
+{
+  const int nodes = sim_config.num_nodes;
+  const int world_size = nodes + 1; // keep the controller-at-rank-0 layout
+  const int ticks = sim_config.num_ticks;
+
+  NodeConfig cfg = sim_config.node;
+  cfg.seed = seed;
+
+  InprocRouter router(world_size);
+  std::vector<std::unique_ptr<InprocTransport>> transports;
+  std::vector<std::unique_ptr<Node>> sim_nodes;
+  std::vector<std::unique_ptr<Failure>> failures;
+  std::vector<char> crashed(nodes, 0), was_crashed(nodes, 0);
+
+  const UidMap uid_map = make_uid_map(sim_config, nodes);
+  for (int r = 1; r <= nodes; ++r) {
+    transports.push_back(std::make_unique<InprocTransport>(router, r));
+    sim_nodes.push_back(std::make_unique<Node>(r, world_size, nodes, cfg,
+                                               *transports.back(), &uid_map));
+    failures.push_back(make_sim_failure(sim_config, uid_map.uid_of(r), seed, nodes));
+    sim_nodes.back()->set_failure_view(failures.back().get());
+  }
+
+  int t0 = 0;
+  if (!sim_config.restore_file.empty())
+  {
+    CheckpointHeader h{};
+    if (!read_checkpoint_header(sim_config.restore_file, h) ||
+        h.num_nodes != nodes || h.seed != seed)
+      throw std::runtime_error("cannot restore from " + sim_config.restore_file);
+    for (int r = 1; r <= nodes; ++r) {
+      std::string blob;
+      if (!read_checkpoint_blob(sim_config.restore_file, r, blob))
+        throw std::runtime_error("checkpoint is missing node " + std::to_string(r));
+      std::istringstream in(blob);
+      sim_nodes[r - 1]->restore_state(in);
+      failures[r - 1]->restore_state(in);
+    }
+    t0 = h.tick + 1;
+  }
+
+  for (int t = t0; t < ticks; ++t)
+  {
+    timing.begin_tick(t);
+    // Phase 1: failure updates + tick_begin (crashed nodes run no
+    // logic; recover() fires on the first tick back online)
+    double tm = timing.now();
+    for (int i = 0; i < nodes; ++i) {
+      Node &node = *sim_nodes[i];
+      Failure &failure = *failures[i];
+      if (auto *net_fail = dynamic_cast<NetworkFailure *>(&failure)) {
+        net_fail->set_is_leader(node.leader_uid() == node.uid());
+      }
+      failure.tick(t);
+      node.set_can_communicate(failure.can_communicate());
+
+      auto *crash = dynamic_cast<CrashFailure *>(&failure);
+      crashed[i] = (crash && crash->is_crashed()) ? 1 : 0;
+      if (was_crashed[i] && !crashed[i])
+        node.recover(t, sim_config.crash_amnesia);
+      was_crashed[i] = crashed[i];
+
+      if (!crashed[i])
+        node.tick_begin(t);
+    }
+    timing.record(TIMING_TICK_BEGIN, tm);
+
+    // Phase 2: all sends, then all receives, then tick_end
+    tm = timing.now();
+    for (int i = 0; i < nodes; ++i)
+      if (!crashed[i]) sim_nodes[i]->tick_send(t);
+    timing.record(TIMING_TICK_SEND, tm);
+    tm = timing.now();
+    for (int i = 0; i < nodes; ++i) {
+      if (!crashed[i]) sim_nodes[i]->tick_recv(t);
+      else sim_nodes[i]->purge_incoming();
+    }
+    timing.record(TIMING_TICK_RECV, tm);
+    tm = timing.now();
+    for (int i = 0; i < nodes; ++i)
+      if (!crashed[i]) sim_nodes[i]->tick_end(t);
+    timing.record(TIMING_TICK_END, tm);
+
+    // Collect logs directly - no gather needed; the batch comes back
+    // from the logger's recycle pool with its capacities intact, so
+    // steady-state ticks fill it without allocating
+    TickLogBatch batch = logger.acquire_batch();
+    batch.tick = t;
+    batch.states.reserve(nodes);
+
+    for (auto &node : sim_nodes) {
+      batch.states.push_back(node->make_state_report(t));
+
+      const MessageBuffer &buf = node->message_buffer();
+      batch.messages.insert(batch.messages.end(), buf.data(),
+                            buf.data() + buf.count());
+
+      for (const auto &e : node->debug_events()) {
+        DebugEntry entry;
+        entry.tick = e.tick;
+        entry.uid = node->uid();
+        entry.message = render_debug_event(e);
+        batch.debug.push_back(std::move(entry));
+      }
+
+      node->clear_message_buffer();
+      node->clear_debug_events();
+    }
+
+    metrics.observe_tick(t, batch.states, batch.messages);
+    recorder.observe_tick(t, batch.states);
+
+    tm = timing.now();
+    logger.log_tick(std::move(batch));
+    timing.record(TIMING_LOG, tm);
+
+    if (sim_config.checkpoint_interval > 0 &&
+        (t + 1) % sim_config.checkpoint_interval == 0)
+    {
+      std::vector<int> uids;
+      std::vector<std::string> blobs;
+      for (int r = 1; r <= nodes; ++r) {
+        sim_nodes[r - 1]->stash_incoming();
+        std::ostringstream blob;
+        sim_nodes[r - 1]->save_state(blob);
+        failures[r - 1]->save_state(blob);
+        uids.push_back(r);
+        blobs.push_back(blob.str());
+      }
+      CheckpointHeader h{CKPT_MAGIC, CKPT_VERSION, t, nodes, seed};
+      if (!write_checkpoint(sim_config.checkpoint_file, h, uids, blobs))
+        std::cerr << "[Controller] Failed to write checkpoint "
+                  << sim_config.checkpoint_file << "\n";
+    }
+  }
+}
+
+static int run_inproc(const SimConfig &sim_config)
+{
+  std::cout << "[Controller] engine=inproc nodes=" << sim_config.num_nodes
+            << " ticks=" << sim_config.num_ticks
+            << " replications=" << sim_config.num_replications << "\n";
+
+  Logger logger;
+  if (!logger.open(sim_config.state_log_file, sim_config.message_log_file,
+                   sim_config.debug_log_file, sim_config.log_async,
+                   sim_config.log_format)) {
+    std::cerr << "[Controller] Failed to open log files\n";
+    return 1;
+  }
+  if (sim_config.delta_state)
+    logger.set_state_delta(sim_config.state_snapshot_interval);
+  if (sim_config.stream_port > 0 &&
+      !logger.enable_stream(sim_config.stream_port))
+    std::cerr << "[Controller] Failed to open stream port "
+              << sim_config.stream_port << ", continuing without\n";
+  logger.log_metadata(sim_config.num_nodes, sim_config.num_ticks,
+                      sim_config.seed);
+
+  MetricsEngine metrics;
+  ScheduleRecorder recorder;
+  TimingEngine timing;
+  if (!sim_config.timing_file.empty())
+    timing.enable(sim_config.timing_per_tick);
+  for (int rep = 0; rep < sim_config.num_replications; ++rep)
+  {
+    const uint64_t rep_seed = replication_seed(sim_config.seed, rep);
+    if (sim_config.num_replications > 1)
+      logger.log_replication(rep, rep_seed);
+
+    metrics.begin_replication();
+    run_inproc_replication(logger, metrics, recorder, timing, sim_config,
+                           rep_seed);
+  }
+
+  logger.close();
+  if (!sim_config.metrics_file.empty() &&
+      !metrics.write(sim_config.metrics_file))
+    std::cerr << "[Controller] Failed to write " << sim_config.metrics_file
+              << "\n";
+  if (!sim_config.schedule_record.empty() &&
+      !recorder.write(sim_config.schedule_record))
+    std::cerr << "[Controller] Failed to write " << sim_config.schedule_record
+              << "\n";
+  if (!sim_config.timing_file.empty() &&
+      !timing.write(sim_config.timing_file))
+    std::cerr << "[Controller] Failed to write " << sim_config.timing_file
+              << "\n";
+  if (sim_config.stress)
+    std::cout << "[Controller] Stress summary: peak "
+              << metrics.peak_tick_messages() << " messages at tick "
+              << metrics.peak_tick() << ", max convergence "
+              << metrics.max_convergence_time() << " ticks\n";
+  std::cout << "[Controller] Simulation complete. Logs written to "
+            << sim_config.state_log_file << " and "
+            << sim_config.message_log_file << "\n";
+  return 0;
+}
+
+// Self-driving scaling sweep: within one MPI allocation, run the
+// configured simulation over doubling rank subsets (3, 5, 9, ... up to
+// the full world) on derived communicators and consolidate ticks/sec
+// plus the per-phase timing totals of every point into one report.
+// One launch produces the whole curve, so the points share nodes and
+// network state and queue wait is paid once.
+static int run_scale_sweep(const std::string &out_path, SimConfig sim_config,
+                           int world_rank, int world_size)
+{
+  if (world_size < 3)
+  {
+    if (world_rank == 0)
+      std::cerr << "Error: -scale-sweep needs at least 3 ranks\n";
+    return 1;
+  }
+
+  // Sweep points are single bare replications: no checkpoints, no raw
+  // logs, one run per size
+  sim_config.num_replications = 1;
+  sim_config.num_groups = 1;
+  sim_config.checkpoint_interval = 0;
+  sim_config.restore_file.clear();
+  sim_config.verbose = false;
+  sim_config.node.debug = false;  // already latched from verbose in load_config
+  sim_config.stream_port = 0;
+  // An explicit UID permutation is sized for one node count and the
+  // sweep varies it; fall back to identity ("reverse" scales fine)
+  if (sim_config.uid_layout == "explicit")
+  {
+    sim_config.uid_layout = "identity";
+    sim_config.uid_assignment.clear();
+  }
+
+  std::vector<int> sizes;
+  for (int nodes = 2; nodes + 1 <= world_size; nodes *= 2)
+    sizes.push_back(nodes);
+  if (sizes.empty() || sizes.back() != world_size - 1)
+    sizes.push_back(world_size - 1);
+
+  json sweep = json::array();
+  for (int nodes : sizes)
+  {
+    const int comm_size = nodes + 1;
+    MPI_Comm sub = MPI_COMM_NULL;
+    MPI_Comm_split(MPI_COMM_WORLD,
+                   world_rank < comm_size ? 0 : MPI_UNDEFINED,
+                   world_rank, &sub);
+
+    double wall = 0.0;
+    TimingEngine timing;
+    timing.enable(false);
+
+    if (sub != MPI_COMM_NULL)
+    {
+      MPI_Comm worker_comm = MPI_COMM_NULL;
+      MPI_Comm_split(sub, world_rank == 0 ? MPI_UNDEFINED : 0,
+                     world_rank, &worker_comm);
+
+      MPI_Barrier(sub);
+      const double t0 = MPI_Wtime();
+
+      if (world_rank == 0)
+      {
+        Logger logger;  // all streams disabled: measure the sim itself
+        logger.open("", "", "", false, "jsonl");
+        MetricsEngine metrics;
+        ScheduleRecorder recorder;
+        metrics.begin_replication();
+        run_controller_replication(logger, metrics, recorder, timing, sub,
+                                   comm_size, nodes, sim_config.num_ticks,
+                                   sim_config);
+        logger.close();
+      }
+      else
+      {
+        std::unique_ptr<Transport> transport;
+        BatchedMpiTransport *batched = nullptr;
+        if (sim_config.transport == "batched") {
+          auto tr = std::make_unique<BatchedMpiTransport>(worker_comm, nodes);
+          batched = tr.get();
+          transport = std::move(tr);
+        } else if (sim_config.transport == "shm") {
+          transport = std::make_unique<ShmTransport>(worker_comm, nodes);
+        } else {
+          transport = std::make_unique<MpiTransport>(sub);
+        }
+        ReportPacker packers[2];
+        NodeConfig cfg = sim_config.node;
+        cfg.seed = sim_config.seed;
+        run_worker_replication(world_rank, sub, comm_size, nodes,
+                               sim_config.num_ticks, cfg, sim_config,
+                               sim_config.seed, *transport, batched,
+                               worker_comm, packers, timing);
+      }
+
+      wall = MPI_Wtime() - t0;
+      timing.reduce(sub, 0);
+
+      if (world_rank == 0)
+      {
+        sweep.push_back({{"ranks", comm_size},
+                         {"num_nodes", nodes},
+                         {"ticks", sim_config.num_ticks},
+                         {"wall_s", wall},
+                         {"ticks_per_sec", sim_config.num_ticks / wall},
+                         {"phases", timing.phases_json()}});
+        std::cout << "[Sweep] n=" << nodes << " ranks=" << comm_size
+                  << " " << sim_config.num_ticks / wall << " ticks/sec\n";
+      }
+
+      if (worker_comm != MPI_COMM_NULL)
+        MPI_Comm_free(&worker_comm);
+      MPI_Comm_free(&sub);
+    }
+    MPI_Barrier(MPI_COMM_WORLD);
+  }
+
+  if (world_rank == 0)
+  {
+    json j;
+    j["scale_sweep"] = true;
+    j["transport"] = sim_config.transport;
+    j["num_ticks"] = sim_config.num_ticks;
+    j["seed"] = sim_config.seed;
+    j["sweep"] = std::move(sweep);
+    std::ofstream out(out_path);
+    if (!out.is_open())
+    {
+      std::cerr << "Error: cannot write " << out_path << "\n";
+      return 1;
+    }
+    out << j.dump(2) << "\n";
+    std::cout << "[Sweep] Report written to " << out_path << "\n";
+  }
+  return 0;
+}
+
 int main(int argc, char **argv)
 {
   MpiEnv env(argc, argv);
@@ -155,6 +1125,18 @@ int main(int argc, char **argv)
   // Load configuration
   std::string config_path = parse_string(argc, argv, "-config", "config.json");
   SimConfig sim_config = load_config(config_path);
+  sim_config.restore_file = parse_string(argc, argv, "-restore", "");
+
+  // Checkpoint/restart is for long single runs; replication batches
+  // and group splits would need per-replication snapshot bookkeeping
+  if ((sim_config.checkpoint_interval > 0 || !sim_config.restore_file.empty()) &&
+      (sim_config.num_replications > 1 || sim_config.num_groups > 1))
+  {
+    if (rank == 0)
+      std::cerr << "Error: checkpoint/restore requires num_replications=1 "
+                   "and num_groups=1\n";
+    return 1;
+  }
 
   const int ticks = sim_config.num_ticks;
   NodeConfig cfg = sim_config.node;
@@ -172,226 +1154,186 @@ int main(int argc, char **argv)
     }
   }
 
+  // Scaling sweep mode: drive the whole rank-count curve internally
+  const std::string sweep_path = parse_string(argc, argv, "-scale-sweep", "");
+  if (!sweep_path.empty())
+  {
+    if (sim_config.engine != "mpi")
+    {
+      if (rank == 0)
+        std::cerr << "Error: -scale-sweep requires the mpi engine\n";
+      return 1;
+    }
+    return run_scale_sweep(sweep_path, sim_config, rank, world_size);
+  }
+
   root_print(rank, "Starting Bully Algorithm Simulation\n");
 
-  // Create a communicator for worker nodes only (excludes rank 0)
+  // In-process engine: the whole simulation runs on rank 0, extra
+  // ranks (if any) exit immediately. Usable without mpirun.
+  if (sim_config.engine == "inproc")
+  {
+    if (rank != 0)
+      return 0;
+    return run_inproc(sim_config);
+  }
+
+  // Parallel replication groups: split the world into num_groups
+  // independent simulations, each with its own controller rank, seed
+  // stream, and log files; replications are dealt round-robin
+  const int num_groups = sim_config.num_groups;
+  MPI_Comm sim_comm = MPI_COMM_WORLD;
+  int group = 0;
+
+  if (num_groups > 1)
+  {
+    if (world_size % num_groups != 0)
+    {
+      if (rank == 0)
+        std::cerr << "Error: world size " << world_size
+                  << " is not divisible into " << num_groups << " groups\n";
+      MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    group = rank / (world_size / num_groups);
+    MPI_Comm_split(MPI_COMM_WORLD, group, rank, &sim_comm);
+  }
+
+  // Rank and size within this group's simulation
+  int sim_rank = rank;
+  int sim_size = world_size;
+  if (num_groups > 1)
+  {
+    MPI_Comm_rank(sim_comm, &sim_rank);
+    MPI_Comm_size(sim_comm, &sim_size);
+  }
+
+  // Create a communicator for worker nodes only (excludes the group controller)
   MPI_Comm worker_comm = MPI_COMM_NULL;
-  int color = (rank == 0) ? MPI_UNDEFINED : 1;
-  MPI_Comm_split(MPI_COMM_WORLD, color, rank, &worker_comm);
+  int color = (sim_rank == 0) ? MPI_UNDEFINED : 1;
+  MPI_Comm_split(sim_comm, color, sim_rank, &worker_comm);
 
-  const auto nodes = world_size - 1;
+  const auto nodes = sim_size - 1;
 
   // Logger for controller
   Logger logger;
 
-  if (rank == 0)
+  if (sim_rank == 0)
   {
-    std::cout << "[Controller] nodes=" << nodes << " ticks=" << ticks
+    std::cout << "[Controller" << (num_groups > 1 ? " g" + std::to_string(group) : "")
+              << "] nodes=" << nodes << " ticks=" << ticks
               << " config=" << config_path << "\n";
 
-    // Open log files
-    if (!logger.open(sim_config.state_log_file, sim_config.message_log_file,
-                     sim_config.debug_log_file)) {
+    // Open log files (per-group names when running multiple groups)
+    std::string state_path = group_log_path(sim_config.state_log_file, group, num_groups);
+    std::string msg_path = group_log_path(sim_config.message_log_file, group, num_groups);
+    std::string debug_path = group_log_path(sim_config.debug_log_file, group, num_groups);
+
+    if (!logger.open(state_path, msg_path, debug_path,
+                     sim_config.log_async, sim_config.log_format)) {
       std::cerr << "[Controller] Failed to open log files\n";
       MPI_Abort(MPI_COMM_WORLD, 1);
     }
+    if (sim_config.delta_state)
+      logger.set_state_delta(sim_config.state_snapshot_interval);
+    // Per-group port offset keeps multi-group controllers from
+    // colliding on the same endpoint
+    if (sim_config.stream_port > 0 &&
+        !logger.enable_stream(sim_config.stream_port + group))
+      std::cerr << "[Controller] Failed to open stream port "
+                << sim_config.stream_port + group << ", continuing without\n";
     logger.log_metadata(nodes, ticks, sim_config.seed);
 
-    // Controller simulation loop
-    for (int t = 0; t < ticks; ++t)
+    MetricsEngine metrics;
+    ScheduleRecorder recorder;
+    TimingEngine timing;
+    if (!sim_config.timing_file.empty())
+      timing.enable(sim_config.timing_per_tick);
+    for (int rep = group; rep < sim_config.num_replications; rep += num_groups)
     {
-      // Receive state reports from all ranks via MPI_Gather
-      // Note: world_size includes rank 0, so we allocate for all ranks
-      std::vector<StateReport> all_states_raw(world_size);
-      StateReport dummy{}; // Controller doesn't have a state
-
-      MPI_Gather(&dummy, sizeof(StateReport), MPI_BYTE,
-                 all_states_raw.data(), sizeof(StateReport), MPI_BYTE,
-                 0, MPI_COMM_WORLD);
-
-      // Extract only node states (skip rank 0's dummy data)
-      std::vector<StateReport> all_states(all_states_raw.begin() + 1, all_states_raw.end());
-
-      // Receive message event counts from all ranks
-      std::vector<int> msg_counts_raw(world_size);
-      int dummy_count = 0;
-
-      MPI_Gather(&dummy_count, 1, MPI_INT,
-                 msg_counts_raw.data(), 1, MPI_INT,
-                 0, MPI_COMM_WORLD);
-
-      // Calculate displacements for MPI_Gatherv (includes all ranks)
-      std::vector<int> displs(world_size);
-      std::vector<int> byte_counts(world_size);
-      int total_msgs = 0;
-
-      for (int i = 0; i < world_size; ++i) {
-        displs[i] = total_msgs * static_cast<int>(sizeof(MessageEvent));
-        byte_counts[i] = msg_counts_raw[i] * static_cast<int>(sizeof(MessageEvent));
-        total_msgs += msg_counts_raw[i];
-      }
-
-      // Gather all message events
-      std::vector<MessageEvent> all_msgs(total_msgs > 0 ? total_msgs : 1);
-      MessageEvent dummy_event{};
-
-      MPI_Gatherv(&dummy_event, 0, MPI_BYTE,
-                  all_msgs.data(), byte_counts.data(), displs.data(), MPI_BYTE,
-                  0, MPI_COMM_WORLD);
-
-      // Resize to actual count (in case we allocated 1 for empty case)
-      if (total_msgs == 0) all_msgs.clear();
-
-      // Gather debug messages from all ranks
-      // Each node sends: count of messages, then for each: length + string data
-      std::vector<int> debug_counts_raw(world_size);
-      int dummy_debug_count = 0;
-
-      MPI_Gather(&dummy_debug_count, 1, MPI_INT,
-                 debug_counts_raw.data(), 1, MPI_INT,
-                 0, MPI_COMM_WORLD);
-
-      // Gather serialized debug strings (each node serializes all its messages as JSON array)
-      std::vector<int> debug_str_lens_raw(world_size);
-      int dummy_str_len = 0;
-
-      MPI_Gather(&dummy_str_len, 1, MPI_INT,
-                 debug_str_lens_raw.data(), 1, MPI_INT,
-                 0, MPI_COMM_WORLD);
+      if (sim_config.num_replications > 1)
+        logger.log_replication(rep, replication_seed(sim_config.seed, rep));
 
-      // Calculate displacements for string data
-      std::vector<int> debug_displs(world_size);
-      int total_debug_bytes = 0;
-      for (int i = 0; i < world_size; ++i) {
-        debug_displs[i] = total_debug_bytes;
-        total_debug_bytes += debug_str_lens_raw[i];
-      }
-
-      // Gather all debug string data
-      std::vector<char> debug_data(total_debug_bytes > 0 ? total_debug_bytes : 1);
-      char dummy_char = '\0';
-
-      MPI_Gatherv(&dummy_char, 0, MPI_BYTE,
-                  debug_data.data(), debug_str_lens_raw.data(), debug_displs.data(), MPI_BYTE,
-                  0, MPI_COMM_WORLD);
-
-      // Parse debug messages and log them
-      std::vector<DebugEntry> all_debug;
-      for (int i = 1; i < world_size; ++i) {  // Skip rank 0
-        if (debug_str_lens_raw[i] > 0) {
-          std::string json_str(debug_data.data() + debug_displs[i], debug_str_lens_raw[i]);
-          try {
-            json j = json::parse(json_str);
-            for (const auto& msg : j) {
-              DebugEntry entry;
-              entry.tick = t;
-              entry.uid = i;  // rank == uid for nodes
-              entry.message = msg.get<std::string>();
-              all_debug.push_back(entry);
-            }
-          } catch (...) {
-            // Ignore parse errors
-          }
-        }
-      }
-
-      // Log everything
-      logger.log_states(t, all_states);
-      logger.log_messages(all_msgs);
-      logger.log_debug(all_debug);
-
-      // Sync point with workers
-      MPI_Barrier(MPI_COMM_WORLD);
+      metrics.begin_replication();
+      run_controller_replication(logger, metrics, recorder, timing, sim_comm,
+                                 sim_size, nodes, ticks, sim_config);
     }
+    timing.reduce(sim_comm, 0);
 
     logger.close();
-    std::cout << "[Controller] Simulation complete. Logs written to "
-              << sim_config.state_log_file << " and " << sim_config.message_log_file << "\n";
+    if (!sim_config.metrics_file.empty()) {
+      std::string metrics_path =
+          group_log_path(sim_config.metrics_file, group, num_groups);
+      if (!metrics.write(metrics_path))
+        std::cerr << "[Controller] Failed to write " << metrics_path << "\n";
+    }
+    if (!sim_config.schedule_record.empty()) {
+      std::string sched_path =
+          group_log_path(sim_config.schedule_record, group, num_groups);
+      if (!recorder.write(sched_path))
+        std::cerr << "[Controller] Failed to write " << sched_path << "\n";
+    }
+    if (!sim_config.timing_file.empty()) {
+      std::string timing_path =
+          group_log_path(sim_config.timing_file, group, num_groups);
+      if (!timing.write(timing_path))
+        std::cerr << "[Controller] Failed to write " << timing_path << "\n";
+    }
+    if (sim_config.stress)
+      std::cout << "[Controller] Stress summary: peak "
+                << metrics.peak_tick_messages() << " messages at tick "
+                << metrics.peak_tick() << ", max convergence "
+                << metrics.max_convergence_time() << " ticks\n";
+    std::cout << "[Controller" << (num_groups > 1 ? " g" + std::to_string(group) : "")
+              << "] Simulation complete. Logs written to "
+              << state_path << " and " << msg_path << "\n";
   }
   else
   {
-    Node node(rank, world_size, nodes, cfg);
-
-    // Create failure model for this node
-    auto failure = make_failure(
-        sim_config.failure_type,
-        rank,  // uid == rank for nodes
-        sim_config.seed,
-        sim_config.failure);
+    // Select transport: batched accumulates the tick's messages and
+    // exchanges them in one collective; p2p sends each immediately
+    std::unique_ptr<Transport> transport;
+    BatchedMpiTransport* batched = nullptr;
+    if (sim_config.transport == "batched") {
+      auto t = std::make_unique<BatchedMpiTransport>(worker_comm, nodes);
+      batched = t.get();
+      transport = std::move(t);
+    } else if (sim_config.transport == "shm") {
+      transport = std::make_unique<ShmTransport>(worker_comm, nodes);
+    } else {
+      transport = std::make_unique<MpiTransport>(sim_comm);
+    }
 
-    for (int t = 0; t < ticks; ++t)
-    {
-      MPI_Barrier(worker_comm);
+    // Reused packed-report buffers, one per pipeline slot (each grows
+    // to its high-water mark once)
+    ReportPacker packers[2];
 
-      // Update failure state for this tick
-      if (auto* net_fail = dynamic_cast<NetworkFailure*>(failure.get())) {
-        net_fail->set_is_leader(node.leader_uid() == node.uid());
-      }
-      failure->tick(t);
+    TimingEngine timing;
+    if (!sim_config.timing_file.empty())
+      timing.enable(sim_config.timing_per_tick);
 
-      // Inject communication status into node
-      node.set_can_communicate(failure->can_communicate());
+    for (int rep = group; rep < sim_config.num_replications; rep += num_groups)
+    {
+      // Fresh node and failure state each replication, re-seeded so
+      // every replication is an independent sample
+      const uint64_t rep_seed = replication_seed(sim_config.seed, rep);
+      NodeConfig rep_cfg = cfg;
+      rep_cfg.seed = rep_seed;
 
-      node.tick_begin(t);
-      node.tick_send(t);
-      node.tick_recv(t);
-      node.tick_end(t);
+      run_worker_replication(sim_rank, sim_comm, sim_size, nodes, ticks,
+                             rep_cfg, sim_config, rep_seed, *transport,
+                             batched, worker_comm, packers, timing);
 
+      // Flush any leftover traffic before the next replication starts
       MPI_Barrier(worker_comm);
-
-      // Send state report to controller
-      StateReport report = node.make_state_report(t);
-      MPI_Gather(&report, sizeof(StateReport), MPI_BYTE,
-                 nullptr, 0, MPI_BYTE,
-                 0, MPI_COMM_WORLD);
-
-      // Send message event count
-      int msg_count = node.message_buffer().count();
-      MPI_Gather(&msg_count, 1, MPI_INT,
-                 nullptr, 0, MPI_INT,
-                 0, MPI_COMM_WORLD);
-
-      // Send message events via Gatherv
-      MPI_Gatherv(node.message_buffer().data(),
-                  msg_count * static_cast<int>(sizeof(MessageEvent)), MPI_BYTE,
-                  nullptr, nullptr, nullptr, MPI_BYTE,
-                  0, MPI_COMM_WORLD);
-
-      // Send debug message count
-      int debug_count = static_cast<int>(node.debug_messages().size());
-      MPI_Gather(&debug_count, 1, MPI_INT,
-                 nullptr, 0, MPI_INT,
-                 0, MPI_COMM_WORLD);
-
-      // Serialize debug messages as JSON array
-      std::string debug_json;
-      if (!node.debug_messages().empty()) {
-        json j = node.debug_messages();
-        debug_json = j.dump();
-      }
-      int debug_str_len = static_cast<int>(debug_json.size());
-
-      // Send debug string length
-      MPI_Gather(&debug_str_len, 1, MPI_INT,
-                 nullptr, 0, MPI_INT,
-                 0, MPI_COMM_WORLD);
-
-      // Send debug string data
-      MPI_Gatherv(debug_json.data(), debug_str_len, MPI_BYTE,
-                  nullptr, nullptr, nullptr, MPI_BYTE,
-                  0, MPI_COMM_WORLD);
-
-      // Clear buffers for next tick
-      node.clear_message_buffer();
-      node.clear_debug_messages();
-
-      // Sync with controller
-      MPI_Barrier(MPI_COMM_WORLD);
+      transport->reset();
     }
+    timing.reduce(sim_comm, 0);
   }
 
   if (worker_comm != MPI_COMM_NULL)
     MPI_Comm_free(&worker_comm);
+  if (sim_comm != MPI_COMM_WORLD && sim_comm != MPI_COMM_NULL)
+    MPI_Comm_free(&sim_comm);
 
   return 0;
 }
\ No newline at end of file
@@ -1,5 +1,6 @@
 #pragma once
 #include <cstdint>
+#include <string>
 
 enum class MsgType : int32_t {
     HEARTBEAT   = 1,
@@ -29,4 +30,161 @@ struct StateReport {
     int32_t leader_uid;   // -1 unknown
     int32_t election_active; // 0/1
     int32_t last_hb_tick; // -1 if never
-};
\ No newline at end of file
+};
+
+// True when `cur` carries no new information relative to `prev` for
+// delta state reporting. Between elections the only field that moves is
+// last_hb_tick, which advances in lockstep with the tick under a stable
+// leader - so "unchanged" means equal flags and equal heartbeat *age*
+// (tick - last_hb_tick), not equal timestamp. A reader holding `prev`
+// can then reconstruct `cur` exactly by advancing last_hb_tick at tick
+// rate (or leaving -1 alone).
+inline bool state_report_unchanged(const StateReport& prev,
+                                   const StateReport& cur) {
+    if (prev.uid != cur.uid || prev.online != cur.online ||
+        prev.leader_uid != cur.leader_uid ||
+        prev.election_active != cur.election_active)
+        return false;
+    if (prev.last_hb_tick < 0 || cur.last_hb_tick < 0)
+        return prev.last_hb_tick == cur.last_hb_tick;
+    return cur.tick - cur.last_hb_tick == prev.tick - prev.last_hb_tick;
+}
+
+// Reconstruct the full report for `tick` from a cached report that an
+// unchanged marker was sent against (inverse of the predicate above)
+inline StateReport advance_state_report(StateReport cached, int tick) {
+    if (cached.last_hb_tick >= 0)
+        cached.last_hb_tick += tick - cached.tick;
+    cached.tick = tick;
+    return cached;
+}
+
+// Event logged when a message is sent or received
+struct MessageEvent {
+    int32_t tick;
+    int32_t type;       // MsgType
+    int32_t src_uid;
+    int32_t dst_uid;    // -1 for broadcast
+    int32_t dropped;    // 0 = delivered, 1 = dropped
+    int32_t direction;  // 0 = sent, 1 = received
+    int32_t padding[2]; // Ensure 32-byte alignment
+};
+
+// Helper to convert MsgType to string
+inline const char* msg_type_to_string(int32_t type) {
+    switch (static_cast<MsgType>(type)) {
+        case MsgType::HEARTBEAT:    return "HEARTBEAT";
+        case MsgType::ELECTION:     return "ELECTION";
+        case MsgType::OK:           return "OK";
+        case MsgType::COORDINATOR:  return "COORDINATOR";
+        case MsgType::PING:         return "PING";
+        case MsgType::ACK:          return "ACK";
+        case MsgType::STATE_REPORT: return "STATE_REPORT";
+        default:                    return "UNKNOWN";
+    }
+}
+
+// Debug message entry for logging
+struct DebugEntry {
+    int32_t tick;
+    int32_t uid;
+    std::string message;
+};
+
+// Structured debug events: nodes record these fixed-size codes into a
+// preallocated buffer instead of formatting strings on the tick path;
+// the human-readable text is rendered controller-side (or by the log
+// converter) via render_debug_event
+enum class DebugCode : int32_t {
+    HB_TIMEOUT = 1,     // heartbeat timeout, starting election
+    COORD_TIMEOUT,      // no COORDINATOR after OK, restarting election
+    WON_ELECTION,       // becoming leader
+    COORD_BROADCAST,    // -> COORDINATOR to all
+    HB_BROADCAST,       // -> HEARTBEAT to all
+    ELECTION_SENT,      // arg0 = dst, arg1 = dropped
+    NO_HIGHER_NODES,    // highest UID, winning immediately
+    HB_RECV,            // arg0 = src
+    OK_SENT,            // arg0 = dst, arg1 = dropped
+    ELECTION_RECV,      // arg0 = src (lower UID, starting own election)
+    OK_RECV,            // arg0 = src (yielding)
+    COORD_ACCEPTED,     // arg0 = src
+    COORD_REJECTED,     // arg0 = src (lower UID)
+    ACK_SENT,           // arg0 = dst, arg1 = dropped
+    PING_SENT           // arg0 = dst, arg1 = dropped
+};
+
+// Coarse debug categories for gating event recording at the source
+// (logging.debug_categories). A disabled category costs one branch in
+// debug_event and records nothing - no buffer write, no gather bytes.
+enum DebugCategory : uint32_t {
+    DEBUG_ELECTIONS  = 1u << 0,  // election lifecycle, OK/COORDINATOR
+    DEBUG_HEARTBEATS = 1u << 1,  // heartbeat broadcast/receive
+    DEBUG_PINGS      = 1u << 2,  // ping/ACK background chatter
+    DEBUG_ALL        = 0xFFFFFFFFu
+};
+
+inline uint32_t debug_category(DebugCode code) {
+    switch (code) {
+        case DebugCode::HB_BROADCAST:
+        case DebugCode::HB_RECV:
+            return DEBUG_HEARTBEATS;
+        case DebugCode::ACK_SENT:
+        case DebugCode::PING_SENT:
+            return DEBUG_PINGS;
+        default:
+            // Election lifecycle, including the heartbeat timeout that
+            // triggers one - the signal you keep when trimming chatter
+            return DEBUG_ELECTIONS;
+    }
+}
+
+struct DebugEvent {
+    int32_t tick;
+    int32_t code;  // DebugCode
+    int32_t arg0;
+    int32_t arg1;
+};
+
+// Render a structured debug event to the log text the string-based
+// debug_print used to produce
+inline std::string render_debug_event(const DebugEvent& e) {
+    const std::string a0 = std::to_string(e.arg0);
+    const bool dropped = e.arg1 != 0;
+    switch (static_cast<DebugCode>(e.code)) {
+        case DebugCode::HB_TIMEOUT:
+            return "⏱ timeout: no heartbeat from leader, starting election";
+        case DebugCode::COORD_TIMEOUT:
+            return "⏱ timeout: no COORDINATOR received, restarting election";
+        case DebugCode::WON_ELECTION:
+            return "\U0001f451 won election: becoming leader";
+        case DebugCode::COORD_BROADCAST:
+            return "→ COORDINATOR to all: I am leader";
+        case DebugCode::HB_BROADCAST:
+            return "→ HEARTBEAT to all";
+        case DebugCode::ELECTION_SENT:
+            return dropped ? "✗ ELECTION to " + a0 + " (dropped)"
+                           : "→ ELECTION to " + a0;
+        case DebugCode::NO_HIGHER_NODES:
+            return "\U0001f451 no higher nodes: winning immediately";
+        case DebugCode::HB_RECV:
+            return "← HEARTBEAT from " + a0;
+        case DebugCode::OK_SENT:
+            return dropped ? "✗ OK to " + a0 + " (dropped)"
+                           : "→ OK to " + a0;
+        case DebugCode::ELECTION_RECV:
+            return "← ELECTION from " + a0 + ": starting own election";
+        case DebugCode::OK_RECV:
+            return "← OK from " + a0 + ": yielding, waiting for COORDINATOR";
+        case DebugCode::COORD_ACCEPTED:
+            return "← COORDINATOR from " + a0 + ": accepted as leader";
+        case DebugCode::COORD_REJECTED:
+            return "← COORDINATOR from " + a0 + ": rejected (lower UID), starting election";
+        case DebugCode::ACK_SENT:
+            return dropped ? "✗ ACK to " + a0 + " (dropped)"
+                           : "→ ACK to " + a0;
+        case DebugCode::PING_SENT:
+            return dropped ? "✗ PING to " + a0 + " (dropped)"
+                           : "→ PING to " + a0;
+    }
+    return "UNKNOWN";
+}
\ No newline at end of file
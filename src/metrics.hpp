@@ -0,0 +1,198 @@
+#pragma once
+#include <algorithm>
+#include <fstream>
+#include <numeric>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "messages.hpp"
+
+// Streaming metrics engine for the controller (rank 0).
+//
+// Accumulates the same election metrics scripts/metrics.py computes
+// from the raw JSONL logs - elections started, agreement ratio,
+// convergence times after leader failures - plus per-type message
+// counters and leader uptime, all in O(nodes) per tick. Lets sweep
+// runs skip raw message logging entirely: a multi-gigabyte log
+// post-processing pass becomes a few kilobytes of metrics.json.
+class MetricsEngine {
+public:
+    // Reset the per-episode trackers at a replication boundary so a
+    // leader carried over from the previous run does not count as a
+    // failure; cumulative totals keep accumulating
+    void begin_replication() {
+        prev_leader_ = -1;
+        leader_lost_tick_ = -1;
+        std::fill(prev_election_.begin(), prev_election_.end(), 0);
+        ++replications_;
+    }
+
+    // Feed one tick of gathered state and message events
+    void observe_tick(int tick, const std::vector<StateReport>& states,
+                      const std::vector<MessageEvent>& events) {
+        ++total_ticks_;
+
+        // Peak per-tick load (election storms show up here)
+        if (static_cast<long long>(events.size()) > peak_tick_messages_) {
+            peak_tick_messages_ = static_cast<long long>(events.size());
+            peak_tick_ = tick;
+        }
+
+        for (const auto& e : events) {
+            int type = e.type;
+            if (type < 0 || type >= NUM_MSG_TYPES) type = 0;
+            if (e.direction == 0) {
+                ++sent_[type];
+                if (e.dropped) ++dropped_[type];
+            } else {
+                ++received_[type];
+            }
+        }
+
+        if (prev_election_.size() < states.size() + 1)
+            prev_election_.resize(states.size() + 1, 0);
+
+        // Leader agreement across online nodes
+        int agreed_leader = -1;
+        bool all_agree = true;
+        bool any_online = false;
+        for (const auto& s : states) {
+            if (!s.online) continue;
+            if (!any_online) {
+                agreed_leader = s.leader_uid;
+                any_online = true;
+            } else if (s.leader_uid != agreed_leader) {
+                all_agree = false;
+            }
+        }
+
+        // Elections started: nodes whose election flag rose this tick
+        for (const auto& s : states) {
+            char active = s.election_active ? 1 : 0;
+            if (active && !prev_election_[s.uid]) ++elections_started_;
+            prev_election_[s.uid] = active;
+        }
+
+        if (!any_online)
+            return;
+
+        if (agreed_leader == -1) all_agree = false;
+
+        bool agreed_leader_online = false;
+        if (all_agree) {
+            for (const auto& s : states) {
+                if (s.uid == agreed_leader && s.online) {
+                    agreed_leader_online = true;
+                    break;
+                }
+            }
+        }
+
+        if (all_agree) ++agreement_ticks_;
+        if (all_agree && agreed_leader_online) ++leader_uptime_ticks_;
+
+        // Convergence episodes: opened when the known leader drops
+        // offline (or views diverge), closed when all online nodes
+        // agree on an online leader again
+        if (prev_leader_ != -1 && leader_lost_tick_ < 0) {
+            bool prev_leader_online = false;
+            for (const auto& s : states) {
+                if (s.uid == prev_leader_ && s.online) {
+                    prev_leader_online = true;
+                    break;
+                }
+            }
+            if (!prev_leader_online) {
+                leader_lost_tick_ = tick;
+                ++leader_failures_;
+            }
+        }
+        if (!all_agree && leader_lost_tick_ < 0)
+            leader_lost_tick_ = tick;
+
+        if (leader_lost_tick_ >= 0 && all_agree && agreed_leader_online) {
+            convergence_times_.push_back(tick - leader_lost_tick_);
+            prev_leader_ = agreed_leader;
+            leader_lost_tick_ = -1;
+        } else if (all_agree && leader_lost_tick_ < 0) {
+            prev_leader_ = agreed_leader;
+        }
+    }
+
+    // Headline stress numbers for the end-of-run console summary
+    long long peak_tick_messages() const { return peak_tick_messages_; }
+    int peak_tick() const { return peak_tick_; }
+    int max_convergence_time() const {
+        return convergence_times_.empty()
+                   ? 0
+                   : *std::max_element(convergence_times_.begin(),
+                                       convergence_times_.end());
+    }
+
+    // Emit the accumulated metrics as JSON (same key names as
+    // scripts/metrics.py where the metrics overlap)
+    bool write(const std::string& path) const {
+        std::ofstream out(path);
+        if (!out.is_open()) return false;
+
+        nlohmann::json j;
+        j["total_ticks"] = total_ticks_;
+        j["replications"] = replications_ > 0 ? replications_ : 1;
+        j["elections_started"] = elections_started_;
+        j["election_rate_per_100"] =
+            total_ticks_ > 0 ? 100.0 * elections_started_ / total_ticks_ : 0.0;
+        j["agreement_ticks"] = agreement_ticks_;
+        j["agreement_ratio"] =
+            total_ticks_ > 0 ? static_cast<double>(agreement_ticks_) / total_ticks_ : 0.0;
+        j["leader_uptime_ticks"] = leader_uptime_ticks_;
+        j["leader_availability"] =
+            total_ticks_ > 0 ? static_cast<double>(leader_uptime_ticks_) / total_ticks_ : 0.0;
+        j["leader_failures"] = leader_failures_;
+        j["convergence_times"] = convergence_times_;
+        j["max_convergence_time"] = max_convergence_time();
+        j["peak_tick_messages"] = peak_tick_messages_;
+        j["peak_tick"] = peak_tick_;
+        j["avg_convergence_time"] =
+            convergence_times_.empty()
+                ? 0.0
+                : static_cast<double>(std::accumulate(convergence_times_.begin(),
+                                                      convergence_times_.end(), 0LL)) /
+                      convergence_times_.size();
+
+        nlohmann::json msgs;
+        for (int type = 1; type < NUM_MSG_TYPES; ++type) {
+            if (sent_[type] == 0 && received_[type] == 0) continue;
+            msgs[msg_type_to_string(type)] = {
+                {"sent", sent_[type]},
+                {"dropped", dropped_[type]},
+                {"received", received_[type]}
+            };
+        }
+        j["messages"] = msgs;
+
+        out << j.dump(2) << "\n";
+        return true;
+    }
+
+private:
+    static constexpr int NUM_MSG_TYPES = 8;  // MsgType values 1..7
+
+    long long total_ticks_ = 0;
+    int replications_ = 0;
+    long long elections_started_ = 0;
+    long long agreement_ticks_ = 0;
+    long long leader_uptime_ticks_ = 0;
+    long long leader_failures_ = 0;
+    long long peak_tick_messages_ = 0;
+    int peak_tick_ = -1;
+    std::vector<int> convergence_times_;
+
+    long long sent_[NUM_MSG_TYPES] = {};
+    long long dropped_[NUM_MSG_TYPES] = {};
+    long long received_[NUM_MSG_TYPES] = {};
+
+    // Episode tracker state
+    int prev_leader_ = -1;
+    int leader_lost_tick_ = -1;
+    std::vector<char> prev_election_;
+};
@@ -1,11 +1,52 @@
 #pragma once
-#include <mpi.h>
 #include <random>
 #include <algorithm>
+#include <deque>
 #include "messages.hpp"
 #include "logger.hpp"
+#include "transport.hpp"
 #include "failure.hpp"  // For mix_seed utility
 
+// Rank <-> UID assignment for nodes (ranks 1..N, UIDs 1..N). Identity
+// by default; a custom permutation decouples election priority from
+// MPI placement - e.g. clustering the high-UID nodes that answer every
+// ELECTION onto co-located ranks, or modeling priority layouts where
+// the top UIDs share a rack and fail together. Both directions are
+// O(1) table lookups.
+class UidMap {
+public:
+    UidMap() = default;  // identity mapping
+
+    // uid_of_rank[i] is the UID assigned to rank i+1; must be a
+    // permutation of 1..N
+    explicit UidMap(const std::vector<int>& uid_of_rank) {
+        const int n = static_cast<int>(uid_of_rank.size());
+        uid_of_.assign(n + 1, 0);
+        rank_of_.assign(n + 1, 0);
+        for (int r = 1; r <= n; ++r) {
+            const int uid = uid_of_rank[r - 1];
+            if (uid < 1 || uid > n || rank_of_[uid] != 0)
+                throw std::runtime_error(
+                    "uid_assignment must be a permutation of 1.." +
+                    std::to_string(n));
+            uid_of_[r] = uid;
+            rank_of_[uid] = r;
+        }
+    }
+
+    bool identity() const { return uid_of_.empty(); }
+    int uid_of(int rank) const {
+        return uid_of_.empty() ? rank : uid_of_[rank];
+    }
+    int rank_of(int uid) const {
+        return rank_of_.empty() ? uid : rank_of_[uid];
+    }
+
+private:
+    std::vector<int> uid_of_;   // indexed by rank
+    std::vector<int> rank_of_;  // indexed by uid
+};
+
 struct NodeConfig {
     // Heartbeats
     int hb_period_ticks = 1;
@@ -17,24 +58,55 @@ struct NodeConfig {
     // Traffic
     double p_send = 0.30;
     double p_drop = 0.0;
+    int ping_multiplier = 1;  // stress mode: extra p_send draws per tick
 
     int max_recv_per_tick = 64;
+
+    // Delivery delay model: each arriving message waits an extra
+    // uniform [delay_min_ticks, delay_max_ticks] ticks in a pending
+    // heap before dispatch, on top of the transport's usual one-tick
+    // hop. 0/0 (the default) keeps immediate delivery.
+    int delay_min_ticks = 0;
+    int delay_max_ticks = 0;
+
     uint64_t seed = 0;
+    bool counter_rng = false;  // counter-based stream instead of mt19937
 
     bool debug = true;
+
+    // Which debug categories are recorded at all; events in disabled
+    // categories are dropped at the source (see DebugCategory)
+    uint32_t debug_categories = DEBUG_ALL;
 };
 
-class Node
+// Bully-algorithm node. The StaticNodes template parameter optionally
+// fixes the topology size at compile time: with StaticNodes > 0 every
+// broadcast and election loop runs over a constant bound the compiler
+// can unroll and the per-peer send path inlines fully. StaticNodes == 0
+// (the default, and what the stock mpi_bully_sim target uses) keeps
+// the bound a runtime value. Build with -DBULLY_FIXED_NUM_NODES=8 (see
+// the BULLY_FIXED_NODE_TARGETS CMake option) to select a fixed-size
+// specialization.
+template <int StaticNodes = 0>
+class BasicNode
 {
 
 public:
-  Node(int mpi_rank, int world_size, int num_nodes, const NodeConfig &cfg)
+  // uid_map: rank <-> UID assignment (nullptr = identity, uid == rank).
+  // RNG streams are keyed by UID, not rank, so a node's behavior is a
+  // function of its election priority and independent of placement.
+  BasicNode(int mpi_rank, int world_size, int num_nodes, const NodeConfig &cfg,
+            Transport &transport, const UidMap *uid_map = nullptr)
       : rank_(mpi_rank),
         world_size_(world_size),
         num_nodes_(num_nodes),
-        uid_(mpi_rank), // initial: uid == rank (ranks 1..N are nodes)
+        uid_(uid_map ? uid_map->uid_of(mpi_rank) : mpi_rank),
+        uid_map_(uid_map),
         cfg_(cfg),
-        rng_(mix_seed(cfg.seed, static_cast<uint64_t>(mpi_rank)))
+        transport_(transport),
+        rng_(mix_seed(cfg.seed, static_cast<uint64_t>(uid_))),
+        crng_(mix_seed(mix_seed(cfg.seed, static_cast<uint64_t>(uid_)),
+                       RNG_DOMAIN_NODE))
   {
     if (rank_ == 0)
     {
@@ -44,14 +116,35 @@ public:
     {
       throw std::runtime_error("world_size must equal num_nodes + 1");
     }
+    if constexpr (StaticNodes > 0)
+    {
+      if (num_nodes_ != StaticNodes)
+      {
+        throw std::runtime_error(
+            "binary was specialized for " + std::to_string(StaticNodes) +
+            " nodes but num_nodes is " + std::to_string(num_nodes_));
+      }
+    }
 
     leader_uid_ = num_nodes_;
     last_hb_tick_ = -1;
+
+    // Size the event buffers once so logging never allocates mid-tick
+    msg_buffer_.reserve_for_nodes(num_nodes_);
+    debug_events_.reserve(static_cast<size_t>(num_nodes_) * 8 + 32);
+
+    // Delay model: size the pending heap for election-storm bursts up
+    // front so delivery never allocates mid-tick
+    if (cfg_.delay_max_ticks > 0)
+      pending_.reserve(static_cast<size_t>(num_nodes_) * 64 + 1024);
   }
 
   void tick_begin(int tick)
   {
-    (void)tick;
+    // Counter mode: key this tick's random stream so draws are a pure
+    // function of (seed, rank, tick, draw index)
+    if (cfg_.counter_rng)
+      crng_.set_tick(tick);
     // Failure state is now injected externally via set_can_communicate()
   }
   void tick_send(int tick)
@@ -86,7 +179,7 @@ public:
       {
         election_active_ = true;
         election_started_ = false;
-        debug_print(tick, "⏱ timeout: no heartbeat from leader, starting election");
+        debug_event(tick, DebugCode::HB_TIMEOUT);
       }
     }
 
@@ -101,7 +194,7 @@ public:
         ok_received_tick_ = -1;
         election_active_ = true;
         election_started_ = false;
-        debug_print(tick, "⏱ timeout: no COORDINATOR received, restarting election");
+        debug_event(tick, DebugCode::COORD_TIMEOUT);
       }
     }
 
@@ -115,7 +208,7 @@ public:
         leader_uid_ = uid_;
         election_active_ = false;
         election_started_ = false;
-        debug_print(tick, "👑 won election: becoming leader");
+        debug_event(tick, DebugCode::WON_ELECTION);
 
         Message coord{};
         coord.type = static_cast<int32_t>(MsgType::COORDINATOR);
@@ -126,7 +219,7 @@ public:
         coord.aux = 0;
 
         broadcast_to_nodes(coord);
-        debug_print(tick, "→ COORDINATOR to all: I am leader");
+        debug_event(tick, DebugCode::COORD_BROADCAST);
       }
     }
   }
@@ -144,9 +237,74 @@ public:
     return r;
   }
 
+  // Fast-forward eligibility: stable known leader, no election
+  // machinery running, and (for followers) a fresh heartbeat
+  bool is_quiescent(int tick) const
+  {
+    if (!can_communicate_)
+      return false;
+    if (!pending_.empty())
+      return false;
+    if (leader_uid_ == -1 || election_active_ || waiting_for_coordinator_)
+      return false;
+    if (uid_ == leader_uid_)
+      return true;
+    return last_hb_tick_ >= 0 && (tick - last_hb_tick_) < cfg_.hb_timeout_ticks;
+  }
+
+  // Advance one quiet tick locally (no sends or receives). The
+  // fast-forward window guarantees all nodes stay online with a stable
+  // leader, so the leader's heartbeat counts as delivered.
+  void fast_forward_tick(int tick)
+  {
+    if (cfg_.hb_period_ticks > 0 && tick % cfg_.hb_period_ticks == 0)
+      last_hb_tick_ = tick;
+  }
+
+  // Crash recovery (CrashFailure). Amnesia mode loses all volatile
+  // protocol state and rejoins via a fresh election; persistent mode
+  // keeps the pre-crash view and only restarts the running timers so
+  // a stale timestamp does not fire the instant the node wakes up.
+  void recover(int tick, bool amnesia)
+  {
+    if (amnesia)
+    {
+      leader_uid_ = -1;
+      last_hb_tick_ = -1;
+      waiting_for_coordinator_ = false;
+      ok_received_tick_ = -1;
+      election_active_ = true;
+      election_started_ = false;
+    }
+    else
+    {
+      last_hb_tick_ = tick;
+      if (election_active_ && election_started_)
+        election_start_tick_ = tick;
+      if (waiting_for_coordinator_)
+        ok_received_tick_ = tick;
+    }
+  }
+
+  // While crashed the node consumes nothing: anything delivered in the
+  // meantime is lost, exactly as if the process were down
+  void purge_incoming()
+  {
+    Message m{};
+    while (!stashed_.empty())
+      stashed_.pop_front();
+    pending_.clear();
+    while (transport_.try_recv(m))
+      ++transport_received_;
+  }
+
   int uid() const { return uid_; }
   bool can_communicate() const { return can_communicate_; }
   void set_can_communicate(bool can) { can_communicate_ = can; }
+
+  // Per-destination reachability view (partition models); null means
+  // only the all-or-nothing can_communicate_ gate applies
+  void set_failure_view(const Failure *f) { failure_view_ = f; }
   int leader_uid() const { return leader_uid_; }
   bool election_active() const { return election_active_; }
 
@@ -155,9 +313,98 @@ public:
   MessageBuffer& message_buffer() { return msg_buffer_; }
   void clear_message_buffer() { msg_buffer_.clear(); }
 
-  // Debug message buffer access for logging
-  const std::vector<std::string>& debug_messages() const { return debug_messages_; }
-  void clear_debug_messages() { debug_messages_.clear(); }
+  // Debug event buffer access for logging
+  const std::vector<DebugEvent>& debug_events() const { return debug_events_; }
+  void clear_debug_events() { debug_events_.clear(); }
+
+  // Checkpoint/restart support. save_state serializes the algorithm
+  // fields, RNG position, and any stashed in-flight messages;
+  // restore_state is its inverse. stash_incoming pulls undelivered
+  // messages out of the transport at a tick boundary so they land in
+  // the snapshot - drain_incoming redelivers the stash first, so the
+  // continuing run sees them exactly when it would have anyway.
+  void stash_incoming()
+  {
+    Message m{};
+    while (transport_.try_recv(m))
+    {
+      stashed_.push_back(m);
+      ++transport_received_;
+    }
+  }
+
+  // Transport-level send/receive totals; a checkpoint is only
+  // consistent once the global sums match (no message still in flight)
+  long long transport_sent() const { return transport_sent_; }
+  long long transport_received() const { return transport_received_; }
+
+  void save_state(std::ostream &out) const
+  {
+    write_pod(out, static_cast<int32_t>(leader_uid_));
+    write_pod(out, static_cast<int32_t>(last_hb_tick_));
+    write_pod(out, static_cast<int32_t>(can_communicate_ ? 1 : 0));
+    write_pod(out, static_cast<int32_t>(election_active_ ? 1 : 0));
+    write_pod(out, static_cast<int32_t>(election_started_ ? 1 : 0));
+    write_pod(out, static_cast<int32_t>(waiting_for_coordinator_ ? 1 : 0));
+    write_pod(out, static_cast<int32_t>(ok_received_tick_));
+    write_pod(out, static_cast<int32_t>(election_start_tick_));
+    write_pod(out, next_msg_id);
+    write_pod(out, pings_sent);
+    write_pod(out, acks_received);
+    std::ostringstream rng;
+    rng << rng_;
+    write_blob_string(out, rng.str());
+    write_pod(out, static_cast<int32_t>(stashed_.size()));
+    for (const Message &m : stashed_)
+      write_pod(out, m);
+    write_pod(out, pending_seq_);
+    write_pod(out, static_cast<int32_t>(pending_.size()));
+    for (const PendingMessage &p : pending_)
+    {
+      write_pod(out, static_cast<int32_t>(p.due));
+      write_pod(out, p.seq);
+      write_pod(out, p.msg);
+    }
+  }
+
+  void restore_state(std::istream &in)
+  {
+    int32_t v = 0;
+    read_pod(in, v); leader_uid_ = v;
+    read_pod(in, v); last_hb_tick_ = v;
+    read_pod(in, v); can_communicate_ = (v != 0);
+    read_pod(in, v); election_active_ = (v != 0);
+    read_pod(in, v); election_started_ = (v != 0);
+    read_pod(in, v); waiting_for_coordinator_ = (v != 0);
+    read_pod(in, v); ok_received_tick_ = v;
+    read_pod(in, v); election_start_tick_ = v;
+    read_pod(in, next_msg_id);
+    read_pod(in, pings_sent);
+    read_pod(in, acks_received);
+    std::istringstream rng(read_blob_string(in));
+    rng >> rng_;
+    int32_t count = 0;
+    read_pod(in, count);
+    stashed_.clear();
+    for (int32_t i = 0; i < count; ++i)
+    {
+      Message m{};
+      read_pod(in, m);
+      stashed_.push_back(m);
+    }
+    read_pod(in, pending_seq_);
+    read_pod(in, count);
+    pending_.clear();
+    for (int32_t i = 0; i < count; ++i)
+    {
+      PendingMessage p{};
+      read_pod(in, v); p.due = v;
+      read_pod(in, p.seq);
+      read_pod(in, p.msg);
+      pending_.push_back(p);
+    }
+    std::make_heap(pending_.begin(), pending_.end(), pending_later);
+  }
 
 private:
   // MPI / topology
@@ -167,6 +414,7 @@ private:
 
   // Identity
   int uid_;
+  const UidMap *uid_map_;  // nullptr = identity (uid == rank)
 
   // Core state
   int leader_uid_ = -1;
@@ -174,6 +422,7 @@ private:
 
   // Communication state (injected from outside via set_can_communicate)
   bool can_communicate_ = true;
+  const Failure *failure_view_ = nullptr;
 
   // Election state
   bool election_active_ = false;
@@ -184,15 +433,46 @@ private:
 
   NodeConfig cfg_;
 
-  // RNG
+  // Message transport (MPI point-to-point, in-process queues, ...)
+  Transport &transport_;
+
+  // RNG: sequential stream, plus the counter-based alternative whose
+  // per-tick draws need no replay from tick 0 (see CounterRng)
   std::mt19937_64 rng_;
+  CounterRng crng_;
   std::uniform_real_distribution<double> uni_{0.0, 1.0};
 
+  double draw_uniform01()
+  {
+    return cfg_.counter_rng ? uni_(crng_) : uni_(rng_);
+  }
+
   // Message buffer for logging
   MessageBuffer msg_buffer_;
 
-  // Debug message buffer for logging
-  std::vector<std::string> debug_messages_;
+  // Preallocated structured debug event buffer for logging
+  std::vector<DebugEvent> debug_events_;
+
+  // In-flight messages captured at a checkpoint boundary (or loaded
+  // from a snapshot); redelivered before new transport receives
+  std::deque<Message> stashed_;
+
+  // Delay model: arrived-but-not-due messages in a min-heap ordered by
+  // (delivery tick, arrival sequence) so same-tick releases stay FIFO
+  struct PendingMessage
+  {
+    int due;
+    uint32_t seq;
+    Message msg;
+  };
+  static bool pending_later(const PendingMessage &a, const PendingMessage &b)
+  {
+    return a.due != b.due ? a.due > b.due : a.seq > b.seq;
+  }
+  std::vector<PendingMessage> pending_;
+  uint32_t pending_seq_ = 0;
+  long long transport_sent_ = 0;
+  long long transport_received_ = 0;
 
 private:
   int32_t next_msg_id = 0;
@@ -204,6 +484,16 @@ private:
 
   bool is_leader() const { return uid_ == leader_uid_; }
 
+  // Loop bound for per-peer paths: a compile-time constant in the
+  // fixed-topology specialization
+  int node_count() const
+  {
+    if constexpr (StaticNodes > 0)
+      return StaticNodes;
+    else
+      return num_nodes_;
+  }
+
   // Internal helpers
   void maybe_send_heartbeat(int tick)
   {
@@ -215,7 +505,7 @@ private:
       return;
     if (tick % cfg_.hb_period_ticks != 0)
       return;
-    debug_print(tick, "→ HEARTBEAT to all");
+    debug_event(tick, DebugCode::HB_BROADCAST);
     Message m{};
     m.type = static_cast<int32_t>(MsgType::HEARTBEAT);
     m.tick = tick;
@@ -242,25 +532,19 @@ private:
     m.aux = 0;
 
     bool sent_any = false;
-    for (int r = 1; r <= num_nodes_; ++r)
+    for (int u = uid_ + 1; u <= node_count(); ++u)
     {
-      if (r > uid_)  // r is the UID (since uid == rank for nodes)
-      {
-        bool dropped = should_drop_outgoing();
-        send_message(m, r, dropped);
-        if (!dropped) {
-          sent_any = true;
-          debug_print(tick, "→ ELECTION to " + std::to_string(r));
-        } else {
-          debug_print(tick, "✗ ELECTION to " + std::to_string(r) + " (dropped)");
-        }
-      }
+      bool dropped = should_drop_outgoing();
+      send_message(m, u, dropped);
+      if (!dropped)
+        sent_any = true;
+      debug_event(tick, DebugCode::ELECTION_SENT, u, dropped ? 1 : 0);
     }
 
-    if (!sent_any && uid_ == num_nodes_)
+    if (!sent_any && uid_ == node_count())
     {
       // We are the highest UID node - no one to send to, we win immediately
-      debug_print(tick, "👑 no higher nodes: winning immediately");
+      debug_event(tick, DebugCode::NO_HIGHER_NODES);
     }
   }
 
@@ -276,7 +560,7 @@ private:
         last_hb_tick_ = tick;
         election_active_ = false;  // Cancel any ongoing election
         waiting_for_coordinator_ = false;
-        debug_print(tick, "← HEARTBEAT from " + std::to_string(m.src_uid));
+        debug_event(tick, DebugCode::HB_RECV, m.src_uid);
       }
       break;
     case MsgType::ELECTION:
@@ -292,18 +576,14 @@ private:
 
         bool dropped = should_drop_outgoing();
         send_message(ok, m.src_uid, dropped);
-        if (!dropped) {
-          debug_print(tick, "→ OK to " + std::to_string(m.src_uid));
-        } else {
-          debug_print(tick, "✗ OK to " + std::to_string(m.src_uid) + " (dropped)");
-        }
+        debug_event(tick, DebugCode::OK_SENT, m.src_uid, dropped ? 1 : 0);
 
         // If sender has lower UID than us, start our own election
         if (m.src_uid < uid_ && !election_active_)
         {
           election_active_ = true;
           election_started_ = false;
-          debug_print(tick, "← ELECTION from " + std::to_string(m.src_uid) + ": starting own election");
+          debug_event(tick, DebugCode::ELECTION_RECV, m.src_uid);
         }
       }
       break;
@@ -316,7 +596,7 @@ private:
         election_started_ = false;
         waiting_for_coordinator_ = true;
         ok_received_tick_ = tick;
-        debug_print(tick, "← OK from " + std::to_string(m.src_uid) + ": yielding, waiting for COORDINATOR");
+        debug_event(tick, DebugCode::OK_RECV, m.src_uid);
       }
       break;
 
@@ -324,7 +604,7 @@ private:
       if (m.src_uid >= uid_)
       {
         // Accept COORDINATOR from equal or higher priority node
-        debug_print(tick, "← COORDINATOR from " + std::to_string(m.src_uid) + ": accepted as leader");
+        debug_event(tick, DebugCode::COORD_ACCEPTED, m.src_uid);
         leader_uid_ = m.src_uid;
         last_hb_tick_ = tick;
         election_active_ = false;
@@ -335,7 +615,7 @@ private:
       else
       {
         // Reject COORDINATOR from lower priority node - start election
-        debug_print(tick, "← COORDINATOR from " + std::to_string(m.src_uid) + ": rejected (lower UID), starting election");
+        debug_event(tick, DebugCode::COORD_REJECTED, m.src_uid);
         if (!election_active_ && !waiting_for_coordinator_)
         {
           election_active_ = true;
@@ -355,11 +635,7 @@ private:
 
       bool dropped = should_drop_outgoing();
       send_message(ack, ack.dst_uid, dropped);
-      if (!dropped) {
-        debug_print(tick, "→ ACK to " + std::to_string(ack.dst_uid));
-      } else {
-        debug_print(tick, "✗ ACK to " + std::to_string(ack.dst_uid) + " (dropped)");
-      }
+      debug_event(tick, DebugCode::ACK_SENT, ack.dst_uid, dropped ? 1 : 0);
       break;
     }
   default:
@@ -374,20 +650,29 @@ should_drop_outgoing()
   if (cfg_.p_drop <= 0.0)
     return false;
 
-  return uni_(rng_) <= cfg_.p_drop;
+  return draw_uniform01() <= cfg_.p_drop;
+}
+
+int draw_delay()
+{
+  if (cfg_.delay_max_ticks <= cfg_.delay_min_ticks)
+    return cfg_.delay_min_ticks;
+  std::uniform_int_distribution<int> dist(cfg_.delay_min_ticks,
+                                          cfg_.delay_max_ticks);
+  return cfg_.counter_rng ? dist(crng_) : dist(rng_);
 }
 
-int random_peer_rank()
+int random_peer_uid()
 {
-  std::uniform_int_distribution<int> dist(1, num_nodes_);
+  std::uniform_int_distribution<int> dist(1, node_count());
 
-  int r = rank_;
-  while (r == rank_)
+  int u = uid_;
+  while (u == uid_)
   {
-    r = dist(rng_);
+    u = cfg_.counter_rng ? dist(crng_) : dist(rng_);
   }
 
-  return r;
+  return u;
 }
 
 void maybe_send_random_ping(int tick)
@@ -395,76 +680,114 @@ void maybe_send_random_ping(int tick)
   // Algorithm always runs - message filtering happens at transport level
   if (cfg_.p_send <= 0.0)
     return;
-  if (uni_(rng_) >= cfg_.p_send)
-    return;
 
-  const int destination_node = random_peer_rank();
-
-  Message m{};
-  m.type = static_cast<int32_t>(MsgType::PING);
-  m.tick = tick;
-  m.src_uid = uid_;
-  m.dst_uid = destination_node;
-  m.leader_uid = leader_uid_;
-  m.aux = next_msg_id++;
-
-  bool dropped = should_drop_outgoing();
-  send_message(m, destination_node, dropped);
-  if (!dropped) {
-    ++pings_sent;
-    debug_print(tick, "→ PING to " + std::to_string(destination_node));
-  } else {
-    debug_print(tick, "✗ PING to " + std::to_string(m.dst_uid) + " (dropped)");
+  // Stress mode multiplies the background traffic by drawing p_send
+  // several times per tick; the default of 1 keeps the classic single
+  // draw (and its RNG stream) unchanged
+  for (int i = 0; i < cfg_.ping_multiplier; ++i)
+  {
+    if (draw_uniform01() >= cfg_.p_send)
+      continue;
+
+    const int destination_node = random_peer_uid();
+
+    Message m{};
+    m.type = static_cast<int32_t>(MsgType::PING);
+    m.tick = tick;
+    m.src_uid = uid_;
+    m.dst_uid = destination_node;
+    m.leader_uid = leader_uid_;
+    m.aux = next_msg_id++;
+
+    bool dropped = should_drop_outgoing();
+    send_message(m, destination_node, dropped);
+    if (!dropped)
+      ++pings_sent;
+    debug_event(tick, DebugCode::PING_SENT, destination_node, dropped ? 1 : 0);
   }
 }
 
-// MPI send helpers (simple; we'll refine later)
-void send_message(const Message &m, int dst_rank, bool dropped = false)
+// Send helpers (delivery mechanism lives in the Transport). The
+// algorithm addresses peers by UID; the O(1) rank lookup happens here,
+// just before the transport.
+void send_message(const Message &m, int dst_uid, bool dropped = false)
 {
-  // Transport-level filtering: if we can't communicate, message is silently dropped
-  bool effectively_dropped = dropped || !can_communicate_;
+  // Transport-level filtering: if we can't communicate (or the
+  // destination is across a partition), the message is silently dropped
+  bool effectively_dropped = dropped || !can_communicate_ ||
+      (failure_view_ && !failure_view_->can_send_to(dst_uid));
 
   // Log the send event (mark as dropped if we can't communicate)
-  msg_buffer_.log_send(m.tick, m, dst_rank, effectively_dropped);
+  msg_buffer_.log_send(m.tick, m, dst_uid, effectively_dropped);
 
   if (!effectively_dropped) {
-    MPI_Send(
-        &m,
-        static_cast<int>(sizeof(Message)),
-        MPI_BYTE,
-        dst_rank,
-        /*tag*/ 100,
-        MPI_COMM_WORLD);
+    transport_.send(m, uid_map_ ? uid_map_->rank_of(dst_uid) : dst_uid);
+    ++transport_sent_;
   }
 }
 
 void broadcast_to_nodes(const Message &m)
 {
-  for (int r = 1; r <= num_nodes_; ++r)
+  for (int u = 1; u <= node_count(); ++u)
   {
-    if (r == rank_)
+    if (u == uid_)
       continue;
-    send_message(m, r);
+    send_message(m, u);
   }
 }
 
 // Receive helper
 void drain_incoming(int tick)
 {
+  // Delay model: every arrival is heaped with a drawn delivery tick
+  // and only dispatched once due, oldest-due first
+  if (cfg_.delay_max_ticks > 0)
+  {
+    Message m{};
+    for (;;)
+    {
+      if (!stashed_.empty())
+      {
+        m = stashed_.front();
+        stashed_.pop_front();
+      }
+      else if (transport_.try_recv(m))
+        ++transport_received_;
+      else
+        break;
+      pending_.push_back({tick + draw_delay(), pending_seq_++, m});
+      std::push_heap(pending_.begin(), pending_.end(), pending_later);
+    }
+
+    int released = 0;
+    while (released < cfg_.max_recv_per_tick && !pending_.empty() &&
+           pending_.front().due <= tick)
+    {
+      std::pop_heap(pending_.begin(), pending_.end(), pending_later);
+      const Message due = pending_.back().msg;
+      pending_.pop_back();
+      msg_buffer_.log_recv(tick, due);
+      if (can_communicate_)
+        handle_message(due, tick);
+      released++;
+    }
+    return;
+  }
+
   int drained = 0;
 
   while (drained < cfg_.max_recv_per_tick)
   {
-    MPI_Status status;
-    int flag = 0;
-
-    MPI_Iprobe(MPI_ANY_SOURCE, 100, MPI_COMM_WORLD, &flag, &status);
-    if (!flag)
-      break;
-
     Message m{};
-    MPI_Recv(&m, static_cast<int>(sizeof(Message)), MPI_BYTE,
-             status.MPI_SOURCE, 100, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+    if (!stashed_.empty())
+    {
+      m = stashed_.front();
+      stashed_.pop_front();
+    }
+    else if (transport_.try_recv(m))
+      ++transport_received_;
+    else
+      break;
 
     // Log the receive event (even if can't communicate - shows what was missed)
     msg_buffer_.log_recv(tick, m);
@@ -482,17 +805,32 @@ void drain_incoming(int tick)
 
 
 
-void debug_print(int tick, const std::string &msg)
+// Record a structured debug event; text rendering happens on the
+// controller, or locally only when console output is enabled
+void debug_event(int tick, DebugCode code, int arg0 = 0, int arg1 = 0)
 {
-  // Always store for logging (even if debug output is disabled)
-  debug_messages_.push_back(msg);
+  // Gate at record time: a disabled category writes nothing into the
+  // buffer and ships no bytes in the debug gather
+  if (!(cfg_.debug_categories & debug_category(code)))
+    return;
+
+  DebugEvent e{tick, static_cast<int32_t>(code), arg0, arg1};
+  debug_events_.push_back(e);
 
   if (!cfg_.debug)
     return;
 
   std::ostringstream oss;
-  oss << "[T=" << tick << "][R=" << uid_ << "] " << msg << "\n";
+  oss << "[T=" << tick << "][R=" << uid_ << "] " << render_debug_event(e) << "\n";
   std::cout << oss.str();
 }
 }
 ;
+
+// Node-count selection for the whole build: the stock target uses the
+// generic (runtime-sized) node; the _n8/_n16 targets pin it
+#ifdef BULLY_FIXED_NUM_NODES
+using Node = BasicNode<BULLY_FIXED_NUM_NODES>;
+#else
+using Node = BasicNode<>;
+#endif
@@ -0,0 +1,111 @@
+#pragma once
+#include <cstring>
+#include <string>
+#include <vector>
+#include "messages.hpp"
+#include "logger.hpp"
+
+// Packed per-tick reporting protocol.
+//
+// Each worker serializes its StateReport, MessageEvent array, and
+// DebugEvent array into one contiguous buffer; the controller collects
+// all of them with a single MPI_Gatherv per tick (preceded by one size
+// gather) instead of the old five-collective protocol.
+//
+// Buffer layout:
+//   ReportHeader | StateReport? | MessageEvent[msg_count] | DebugEvent[debug_count]
+//
+// With delta state reporting the StateReport is elided when nothing
+// moved since the last shipped report (has_state = 0); the controller
+// reconstructs it from its per-rank cache via advance_state_report().
+
+struct ReportHeader {
+    int32_t msg_count;    // number of MessageEvents
+    int32_t debug_count;  // number of DebugEvents
+    int32_t has_state;    // 0 = unchanged marker, reconstruct from cache
+};
+
+// Builds the packed buffer on the worker side. The buffer is reused
+// across ticks; capacity grows to the high-water mark and stays there.
+class ReportPacker {
+public:
+    void pack(const StateReport& state, bool has_state,
+              const MessageEvent* events, int msg_count,
+              const DebugEvent* debug_events, int debug_count) {
+        ReportHeader header;
+        header.msg_count = msg_count;
+        header.debug_count = debug_count;
+        header.has_state = has_state ? 1 : 0;
+
+        buf_.clear();
+        append(&header, sizeof(header));
+        if (has_state) append(&state, sizeof(state));
+        append(events, msg_count * sizeof(MessageEvent));
+        append(debug_events, debug_count * sizeof(DebugEvent));
+    }
+
+    const char* data() const { return buf_.data(); }
+    int size() const { return static_cast<int>(buf_.size()); }
+
+private:
+    void append(const void* src, size_t bytes) {
+        if (bytes == 0) return;
+        size_t old = buf_.size();
+        buf_.resize(old + bytes);
+        std::memcpy(buf_.data() + old, src, bytes);
+    }
+
+    std::vector<char> buf_;
+};
+
+// View over one worker's packed buffer on the controller side.
+// The events are copied out to avoid alignment assumptions on the
+// gathered byte buffer.
+struct UnpackedReport {
+    bool has_state;       // false: state is absent, use the cached copy
+    StateReport state;
+    std::vector<MessageEvent> events;
+    std::vector<DebugEvent> debug_events;
+};
+
+// Unpack one worker's buffer by appending into caller-owned vectors -
+// the controller loop reuses the same vectors every tick, so
+// steady-state unpacking allocates nothing. Returns false when the
+// report carried an unchanged marker instead of a StateReport (state
+// is left untouched in that case).
+inline bool unpack_report_into(const char* buf, StateReport& state,
+                               std::vector<MessageEvent>& events,
+                               std::vector<DebugEvent>& debug_events) {
+    ReportHeader header;
+    std::memcpy(&header, buf, sizeof(header));
+    buf += sizeof(header);
+
+    const bool has_state = (header.has_state != 0);
+    if (has_state) {
+        std::memcpy(&state, buf, sizeof(state));
+        buf += sizeof(state);
+    }
+
+    if (header.msg_count > 0) {
+        const size_t old = events.size();
+        events.resize(old + header.msg_count);
+        std::memcpy(events.data() + old, buf,
+                    header.msg_count * sizeof(MessageEvent));
+        buf += header.msg_count * sizeof(MessageEvent);
+    }
+
+    if (header.debug_count > 0) {
+        const size_t old = debug_events.size();
+        debug_events.resize(old + header.debug_count);
+        std::memcpy(debug_events.data() + old, buf,
+                    header.debug_count * sizeof(DebugEvent));
+    }
+    return has_state;
+}
+
+inline UnpackedReport unpack_report(const char* buf) {
+    UnpackedReport r;
+    r.state = {};
+    r.has_state = unpack_report_into(buf, r.state, r.events, r.debug_events);
+    return r;
+}
@@ -0,0 +1,203 @@
+#pragma once
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "binlog.hpp"
+#include "messages.hpp"
+
+// Live streaming endpoint for the controller's tick batches.
+//
+// Listens on localhost and pushes length-prefixed frames to one
+// attached viewer (the serve.py relay): each frame is a uint32 byte
+// length followed by exactly one binary-log record (RecordHeader +
+// payload, the same structs binlog.hpp writes to disk), so a stream
+// consumer and a file consumer share one decoder. A freshly accepted
+// client first receives the Metadata record, then every subsequent
+// tick's States/Messages/Debug records - attaching mid-run just means
+// the viewer's window starts at the current tick.
+//
+// The simulation never waits on the viewer: the sockets are
+// nonblocking, and a client too slow to keep up is disconnected and
+// can re-attach. With no client connected publishing is a single
+// branch per tick.
+class StreamPublisher {
+public:
+    ~StreamPublisher() { close(); }
+
+    bool open(int port) {
+        listen_fd_ = ::socket(AF_INET, SOCK_STREAM, 0);
+        if (listen_fd_ < 0) return false;
+        int one = 1;
+        ::setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = htons(static_cast<uint16_t>(port));
+        if (::bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr),
+                   sizeof(addr)) < 0 ||
+            ::listen(listen_fd_, 1) < 0) {
+            ::close(listen_fd_);
+            listen_fd_ = -1;
+            return false;
+        }
+        set_nonblocking(listen_fd_);
+        return true;
+    }
+
+    bool is_open() const { return listen_fd_ >= 0; }
+
+    // Sent as the first frame to every client that attaches
+    void set_metadata(int num_nodes, int num_ticks, uint64_t seed) {
+        meta_ = MetadataRecord{num_nodes, num_ticks, seed};
+        have_meta_ = true;
+    }
+
+    // Push one tick's records to the attached viewer, if any
+    void publish(const std::vector<StateReport>& states,
+                 const std::vector<MessageEvent>& messages,
+                 const std::vector<DebugEntry>& debug) {
+        if (listen_fd_ < 0) return;
+        poll_accept();
+        if (client_fd_ < 0) return;
+
+        frame_.clear();
+        begin_record(RecordKind::States,
+                     static_cast<int32_t>(states.size()));
+        append(states.data(), states.size() * sizeof(StateReport));
+        end_record();
+
+        if (!messages.empty()) {
+            begin_record(RecordKind::Messages,
+                         static_cast<int32_t>(messages.size()));
+            append(messages.data(), messages.size() * sizeof(MessageEvent));
+            end_record();
+        }
+
+        if (!debug.empty()) {
+            begin_record(RecordKind::Debug,
+                         static_cast<int32_t>(debug.size()));
+            for (const auto& e : debug) {
+                const int32_t vals[2] = {e.tick, e.uid};
+                append(vals, sizeof(vals));
+                const auto len = static_cast<int32_t>(e.message.size());
+                append(&len, sizeof(len));
+                append(e.message.data(), e.message.size());
+            }
+            end_record();
+        }
+
+        send_frames();
+    }
+
+    // Replication boundary in multi-seed batch runs
+    void publish_replication(int replication, uint64_t seed) {
+        if (listen_fd_ < 0) return;
+        poll_accept();
+        if (client_fd_ < 0) return;
+
+        frame_.clear();
+        begin_record(RecordKind::Replication, 1);
+        const ReplicationRecord rec{replication, 0, seed};
+        append(&rec, sizeof(rec));
+        end_record();
+        send_frames();
+    }
+
+    void close() {
+        drop_client();
+        if (listen_fd_ >= 0) {
+            ::close(listen_fd_);
+            listen_fd_ = -1;
+        }
+    }
+
+private:
+    static void set_nonblocking(int fd) {
+        ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+    }
+
+    void poll_accept() {
+        const int fd = ::accept(listen_fd_, nullptr, nullptr);
+        if (fd < 0) return;
+        drop_client();  // single viewer; the newest attach wins
+        set_nonblocking(fd);
+        int one = 1;
+        ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        // Generous send buffer so a viewer only gets dropped when it is
+        // genuinely far behind, not on a momentary stall
+        int sndbuf = 4 * 1024 * 1024;
+        ::setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &sndbuf, sizeof(sndbuf));
+        client_fd_ = fd;
+
+        if (have_meta_) {
+            frame_.clear();
+            begin_record(RecordKind::Metadata, 1);
+            append(&meta_, sizeof(meta_));
+            end_record();
+            send_frames();
+        }
+    }
+
+    void drop_client() {
+        if (client_fd_ >= 0) {
+            ::close(client_fd_);
+            client_fd_ = -1;
+        }
+    }
+
+    // Frame assembly: [uint32 length][RecordHeader + payload], built
+    // into a buffer reused across ticks
+    void begin_record(RecordKind kind, int32_t count) {
+        record_start_ = frame_.size();
+        const uint32_t placeholder = 0;
+        append(&placeholder, sizeof(placeholder));
+        RecordHeader header{static_cast<int32_t>(kind), count};
+        append(&header, sizeof(header));
+    }
+
+    void end_record() {
+        const uint32_t len = static_cast<uint32_t>(
+            frame_.size() - record_start_ - sizeof(uint32_t));
+        std::memcpy(frame_.data() + record_start_, &len, sizeof(len));
+    }
+
+    void append(const void* src, size_t bytes) {
+        if (bytes == 0) return;
+        const size_t old = frame_.size();
+        frame_.resize(old + bytes);
+        std::memcpy(frame_.data() + old, src, bytes);
+    }
+
+    // Best-effort write of the assembled frames; a viewer whose socket
+    // buffer is full gets dropped rather than stalling the tick loop
+    void send_frames() {
+        size_t off = 0;
+        while (off < frame_.size()) {
+            const ssize_t n = ::send(client_fd_, frame_.data() + off,
+                                     frame_.size() - off, MSG_NOSIGNAL);
+            if (n > 0) {
+                off += static_cast<size_t>(n);
+                continue;
+            }
+            if (n < 0 && errno == EINTR) continue;
+            drop_client();
+            return;
+        }
+    }
+
+    int listen_fd_ = -1;
+    int client_fd_ = -1;
+    MetadataRecord meta_{};
+    bool have_meta_ = false;
+    size_t record_start_ = 0;
+    std::vector<char> frame_;
+};
@@ -0,0 +1,219 @@
+#pragma once
+#include <mpi.h>
+#include <cstdint>
+#include <fstream>
+#include <limits>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+// Lightweight wall-clock instrumentation for the tick loops.
+//
+// Each phase interval costs exactly two clock reads (MPI_Wtime at open
+// and close) and a handful of adds; when no timing_file is configured
+// now() short-circuits and the loops pay a single branch per phase.
+// Accumulators are preallocated fixed arrays - per-phase count, total,
+// min, max, and a log2-microsecond histogram - so nothing allocates on
+// the hot path. At shutdown the MPI engine sums every rank's
+// accumulators onto the controller with one reduce and writes a
+// timing.json summary; set logging.timing_per_tick to also keep the
+// writing rank's raw per-tick phase durations.
+
+enum TimingPhase {
+    TIMING_BARRIER = 0,  // worker_comm tick barriers
+    TIMING_TICK_BEGIN,
+    TIMING_TICK_SEND,
+    TIMING_EXCHANGE,     // batched transport Alltoall/Alltoallv
+    TIMING_TICK_RECV,
+    TIMING_TICK_END,
+    TIMING_REPORT,       // slot wait + pack + posting the report gathers
+    TIMING_GATHER,       // controller: waiting on the report gathers
+    TIMING_LOG,          // controller: handing the tick to the logger
+    TIMING_CHECKPOINT,
+    TIMING_FF_SYNC,      // fast-forward window Allreduce
+    TIMING_NUM_PHASES
+};
+
+inline const char* timing_phase_name(int p) {
+    switch (p) {
+        case TIMING_BARRIER:    return "barrier";
+        case TIMING_TICK_BEGIN: return "tick_begin";
+        case TIMING_TICK_SEND:  return "tick_send";
+        case TIMING_EXCHANGE:   return "exchange";
+        case TIMING_TICK_RECV:  return "tick_recv";
+        case TIMING_TICK_END:   return "tick_end";
+        case TIMING_REPORT:     return "report";
+        case TIMING_GATHER:     return "gather";
+        case TIMING_LOG:        return "log";
+        case TIMING_CHECKPOINT: return "checkpoint";
+        case TIMING_FF_SYNC:    return "ff_sync";
+        default:                return "unknown";
+    }
+}
+
+class TimingEngine {
+public:
+    static constexpr int NUM_BUCKETS = 24;  // 1us .. ~8s in log2 steps
+
+    void enable(bool per_tick) {
+        enabled_ = true;
+        per_tick_ = per_tick;
+    }
+    bool enabled() const { return enabled_; }
+
+    // Open an interval; returns 0 (and record() no-ops) when disabled
+    double now() const { return enabled_ ? MPI_Wtime() : 0.0; }
+
+    // Close an interval opened with now()
+    void record(TimingPhase p, double t0) {
+        if (!enabled_) return;
+        const double dt = MPI_Wtime() - t0;
+        Stats& s = stats_[p];
+        ++s.count;
+        s.total += dt;
+        if (dt < s.min_v) s.min_v = dt;
+        if (dt > s.max_v) s.max_v = dt;
+        ++s.hist[bucket(dt)];
+        if (per_tick_) tick_row_[p] += dt;
+    }
+
+    // Mark a tick boundary for the per-tick record stream
+    void begin_tick(int tick) {
+        if (!per_tick_) return;
+        flush_tick_row();
+        cur_tick_ = tick;
+    }
+
+    // Sum every rank's accumulators onto root; collective over comm.
+    // Per-tick rows stay local to the writing rank.
+    void reduce(MPI_Comm comm, int root) {
+        if (!enabled_) return;
+        long long counts[TIMING_NUM_PHASES];
+        double totals[TIMING_NUM_PHASES];
+        double mins[TIMING_NUM_PHASES];
+        double maxs[TIMING_NUM_PHASES];
+        unsigned long long hists[TIMING_NUM_PHASES * NUM_BUCKETS];
+        for (int p = 0; p < TIMING_NUM_PHASES; ++p) {
+            counts[p] = stats_[p].count;
+            totals[p] = stats_[p].total;
+            mins[p] = stats_[p].min_v;
+            maxs[p] = stats_[p].max_v;
+            for (int b = 0; b < NUM_BUCKETS; ++b)
+                hists[p * NUM_BUCKETS + b] = stats_[p].hist[b];
+        }
+        int rank = 0;
+        MPI_Comm_rank(comm, &rank);
+        MPI_Reduce(rank == root ? MPI_IN_PLACE : counts, counts,
+                   TIMING_NUM_PHASES, MPI_LONG_LONG, MPI_SUM, root, comm);
+        MPI_Reduce(rank == root ? MPI_IN_PLACE : totals, totals,
+                   TIMING_NUM_PHASES, MPI_DOUBLE, MPI_SUM, root, comm);
+        MPI_Reduce(rank == root ? MPI_IN_PLACE : mins, mins,
+                   TIMING_NUM_PHASES, MPI_DOUBLE, MPI_MIN, root, comm);
+        MPI_Reduce(rank == root ? MPI_IN_PLACE : maxs, maxs,
+                   TIMING_NUM_PHASES, MPI_DOUBLE, MPI_MAX, root, comm);
+        MPI_Reduce(rank == root ? MPI_IN_PLACE : hists, hists,
+                   TIMING_NUM_PHASES * NUM_BUCKETS, MPI_UNSIGNED_LONG_LONG,
+                   MPI_SUM, root, comm);
+        if (rank != root) return;
+        for (int p = 0; p < TIMING_NUM_PHASES; ++p) {
+            stats_[p].count = counts[p];
+            stats_[p].total = totals[p];
+            stats_[p].min_v = mins[p];
+            stats_[p].max_v = maxs[p];
+            for (int b = 0; b < NUM_BUCKETS; ++b)
+                stats_[p].hist[b] = hists[p * NUM_BUCKETS + b];
+        }
+    }
+
+    // Per-phase summary as JSON (shared by write() and the scaling
+    // sweep report)
+    nlohmann::json phases_json() const {
+        nlohmann::json phases;
+        for (int p = 0; p < TIMING_NUM_PHASES; ++p) {
+            const Stats& s = stats_[p];
+            if (s.count == 0) continue;
+            int top = NUM_BUCKETS;
+            while (top > 0 && s.hist[top - 1] == 0) --top;
+            phases[timing_phase_name(p)] = {
+                {"count", s.count},
+                {"total_ms", s.total * 1e3},
+                {"avg_us", s.total * 1e6 / s.count},
+                {"min_us", s.min_v * 1e6},
+                {"max_us", s.max_v * 1e6},
+                {"hist_log2us", std::vector<unsigned long long>(
+                                    s.hist, s.hist + top)}
+            };
+        }
+        return phases;
+    }
+
+    bool write(const std::string& path) {
+        if (!enabled_) return true;
+        flush_tick_row();
+        std::ofstream out(path);
+        if (!out.is_open()) return false;
+
+        nlohmann::json j;
+        j["phases"] = phases_json();
+
+        if (per_tick_) {
+            nlohmann::json rows = nlohmann::json::array();
+            for (const auto& row : rows_) {
+                nlohmann::json r;
+                r["tick"] = row.tick;
+                for (int p = 0; p < TIMING_NUM_PHASES; ++p)
+                    if (row.us[p] > 0.0)
+                        r[timing_phase_name(p)] = row.us[p];
+                rows.push_back(std::move(r));
+            }
+            j["per_tick"] = std::move(rows);
+        }
+
+        out << j.dump(2) << "\n";
+        return out.good();
+    }
+
+private:
+    struct Stats {
+        long long count = 0;
+        double total = 0.0;
+        double min_v = std::numeric_limits<double>::max();
+        double max_v = 0.0;
+        unsigned long long hist[NUM_BUCKETS] = {};
+    };
+
+    struct TickRow {
+        int tick;
+        double us[TIMING_NUM_PHASES];
+    };
+
+    static int bucket(double seconds) {
+        auto us = static_cast<unsigned long long>(seconds * 1e6);
+        int b = 0;
+        while (us > 1 && b < NUM_BUCKETS - 1) {
+            us >>= 1;
+            ++b;
+        }
+        return b;
+    }
+
+    void flush_tick_row() {
+        if (cur_tick_ >= 0) {
+            TickRow row;
+            row.tick = cur_tick_;
+            for (int p = 0; p < TIMING_NUM_PHASES; ++p)
+                row.us[p] = tick_row_[p] * 1e6;
+            rows_.push_back(row);
+        }
+        for (int p = 0; p < TIMING_NUM_PHASES; ++p) tick_row_[p] = 0.0;
+        cur_tick_ = -1;
+    }
+
+    bool enabled_ = false;
+    bool per_tick_ = false;
+    Stats stats_[TIMING_NUM_PHASES];
+
+    double tick_row_[TIMING_NUM_PHASES] = {};
+    int cur_tick_ = -1;
+    std::vector<TickRow> rows_;
+};
@@ -0,0 +1,327 @@
+#pragma once
+#include <mpi.h>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <vector>
+#include "messages.hpp"
+
+// Transport abstraction: how Message structs move between nodes.
+// The Bully logic in Node is transport-agnostic - Node calls send()
+// during its send phase and polls try_recv() during its recv phase.
+// Extend this to implement different delivery mechanisms.
+class Transport {
+public:
+    virtual ~Transport() = default;
+
+    // Deliver a message to the node at dst_rank (best effort, no ack)
+    virtual void send(const Message& m, int dst_rank) = 0;
+
+    // Nonblocking receive; returns false when no message is pending
+    virtual bool try_recv(Message& m) = 0;
+
+    // Discard any buffered or in-flight traffic (between replications).
+    // Callers must synchronize first so no sends are still in progress.
+    virtual void reset() {}
+};
+
+// MPI point-to-point transport: one blocking MPI_Send per message,
+// drained via MPI_Iprobe/MPI_Recv. This is the original behavior.
+class MpiTransport : public Transport {
+public:
+    explicit MpiTransport(MPI_Comm comm = MPI_COMM_WORLD, int tag = 100)
+        : comm_(comm), tag_(tag) {}
+
+    void send(const Message& m, int dst_rank) override {
+        MPI_Send(&m, static_cast<int>(sizeof(Message)), MPI_BYTE,
+                 dst_rank, tag_, comm_);
+    }
+
+    bool try_recv(Message& m) override {
+        MPI_Status status;
+        int flag = 0;
+        MPI_Iprobe(MPI_ANY_SOURCE, tag_, comm_, &flag, &status);
+        if (!flag) return false;
+        MPI_Recv(&m, static_cast<int>(sizeof(Message)), MPI_BYTE,
+                 status.MPI_SOURCE, tag_, comm_, MPI_STATUS_IGNORE);
+        return true;
+    }
+
+    void reset() override {
+        Message discard{};
+        while (try_recv(discard)) {}
+    }
+
+private:
+    MPI_Comm comm_;
+    int tag_;
+};
+
+// Batched MPI transport: outbound messages accumulate in per-destination
+// buffers and the whole tick's traffic moves in one MPI_Alltoallv on the
+// worker communicator. Avoids O(n^2) small sends during election storms.
+//
+// All workers must call exchange() collectively once per tick, between
+// their send and recv phases. Messages sent while handling received
+// messages (OK / ACK replies) ride the next tick's exchange.
+class BatchedMpiTransport : public Transport {
+public:
+    // comm is the worker-only communicator; worker rank = world rank - 1
+    BatchedMpiTransport(MPI_Comm comm, int num_nodes)
+        : comm_(comm),
+          num_nodes_(num_nodes),
+          outboxes_(num_nodes),
+          send_counts_(num_nodes),
+          recv_counts_(num_nodes),
+          send_displs_(num_nodes),
+          recv_displs_(num_nodes)
+    {
+        for (auto& box : outboxes_) box.reserve(num_nodes);
+        send_buf_.reserve(num_nodes * 4);
+        recv_buf_.reserve(num_nodes * 4);
+    }
+
+    void send(const Message& m, int dst_rank) override {
+        outboxes_[dst_rank - 1].push_back(m);
+    }
+
+    bool try_recv(Message& m) override {
+        if (recv_pos_ >= recv_buf_.size()) return false;
+        m = recv_buf_[recv_pos_++];
+        return true;
+    }
+
+    // Collective: exchange this tick's accumulated messages
+    void exchange() {
+        send_buf_.clear();
+        int offset = 0;
+        for (int i = 0; i < num_nodes_; ++i) {
+            send_displs_[i] = offset * static_cast<int>(sizeof(Message));
+            send_counts_[i] = static_cast<int>(outboxes_[i].size())
+                              * static_cast<int>(sizeof(Message));
+            send_buf_.insert(send_buf_.end(), outboxes_[i].begin(), outboxes_[i].end());
+            offset += static_cast<int>(outboxes_[i].size());
+            outboxes_[i].clear();
+        }
+
+        MPI_Alltoall(send_counts_.data(), 1, MPI_INT,
+                     recv_counts_.data(), 1, MPI_INT, comm_);
+
+        int total_bytes = 0;
+        for (int i = 0; i < num_nodes_; ++i) {
+            recv_displs_[i] = total_bytes;
+            total_bytes += recv_counts_[i];
+        }
+
+        recv_buf_.resize(total_bytes / static_cast<int>(sizeof(Message)));
+        MPI_Alltoallv(send_buf_.data(), send_counts_.data(), send_displs_.data(), MPI_BYTE,
+                      recv_buf_.data(), recv_counts_.data(), recv_displs_.data(), MPI_BYTE,
+                      comm_);
+        recv_pos_ = 0;
+    }
+
+    void reset() override {
+        for (auto& box : outboxes_) box.clear();
+        recv_buf_.clear();
+        recv_pos_ = 0;
+    }
+
+private:
+    MPI_Comm comm_;
+    int num_nodes_;
+    std::vector<std::vector<Message>> outboxes_;  // indexed by dst worker rank
+    std::vector<int> send_counts_, recv_counts_;  // in bytes
+    std::vector<int> send_displs_, recv_displs_;
+    std::vector<Message> send_buf_;
+    std::vector<Message> recv_buf_;
+    size_t recv_pos_ = 0;
+};
+
+// Shared-memory transport: ranks co-located on one host pass messages
+// through fixed-slot rings in an MPI-3 shared window instead of the
+// MPI progress engine. Each worker's segment holds one single-producer
+// ring per co-located peer; send() is a store into the destination's
+// ring for the sender's slot set, try_recv() reads the local rings
+// directly - zero-copy within the host. Destinations on another host
+// (or a full ring) fall back to plain MPI_Send on the same tag scheme
+// as MpiTransport, so multi-host launches still work unchanged.
+//
+// The rings are strictly SPSC (one ring per sender/receiver pair), so
+// a release store on the tail and an acquire load on the head are the
+// only synchronization; the tick barrier between the send and recv
+// phases orders whole ticks.
+class ShmTransport : public Transport {
+public:
+    static constexpr int RING_SLOTS = 256;
+    static constexpr int FALLBACK_TAG = 100;
+
+    // comm is the worker-only communicator; worker rank = world rank - 1
+    ShmTransport(MPI_Comm comm, int num_nodes)
+        : comm_(comm), num_nodes_(num_nodes)
+    {
+        MPI_Comm_rank(comm_, &wrank_);
+        MPI_Comm_split_type(comm_, MPI_COMM_TYPE_SHARED, wrank_,
+                            MPI_INFO_NULL, &shm_comm_);
+        MPI_Comm_rank(shm_comm_, &lrank_);
+        MPI_Comm_size(shm_comm_, &lsize_);
+
+        // Map every worker rank to its local rank on this host (-1 if
+        // it lives on another host): same shared-memory leader means
+        // same host
+        int leader = 0;
+        {
+            MPI_Group shm_group, world_group;
+            MPI_Comm_group(shm_comm_, &shm_group);
+            MPI_Comm_group(comm_, &world_group);
+            int zero = 0;
+            MPI_Group_translate_ranks(shm_group, 1, &zero, world_group,
+                                      &leader);
+            MPI_Group_free(&shm_group);
+            MPI_Group_free(&world_group);
+        }
+        std::vector<int> leaders(num_nodes_), lranks(num_nodes_);
+        MPI_Allgather(&leader, 1, MPI_INT, leaders.data(), 1, MPI_INT, comm_);
+        MPI_Allgather(&lrank_, 1, MPI_INT, lranks.data(), 1, MPI_INT, comm_);
+        local_of_.assign(num_nodes_, -1);
+        for (int i = 0; i < num_nodes_; ++i)
+            if (leaders[i] == leaders[wrank_]) local_of_[i] = lranks[i];
+
+        // My segment: one inbound ring per co-located sender
+        char* base = nullptr;
+        MPI_Win_allocate_shared(
+            static_cast<MPI_Aint>(sizeof(Ring)) * lsize_, 1, MPI_INFO_NULL,
+            shm_comm_, &base, &win_);
+        for (int s = 0; s < lsize_; ++s) {
+            Ring* r = reinterpret_cast<Ring*>(base) + s;
+            r->head.store(0, std::memory_order_relaxed);
+            r->tail.store(0, std::memory_order_relaxed);
+        }
+        my_rings_ = reinterpret_cast<Ring*>(base);
+
+        // Resolve every peer's segment once
+        peer_base_.assign(lsize_, nullptr);
+        for (int p = 0; p < lsize_; ++p) {
+            MPI_Aint size = 0;
+            int disp = 0;
+            void* ptr = nullptr;
+            MPI_Win_shared_query(win_, p, &size, &disp, &ptr);
+            peer_base_[p] = reinterpret_cast<Ring*>(ptr);
+        }
+        MPI_Barrier(shm_comm_);
+    }
+
+    ~ShmTransport() override {
+        MPI_Win_free(&win_);
+        MPI_Comm_free(&shm_comm_);
+    }
+
+    void send(const Message& m, int dst_rank) override {
+        const int dst_l = local_of_[dst_rank - 1];
+        if (dst_l >= 0) {
+            // My dedicated ring in the destination's segment
+            Ring* r = peer_base_[dst_l] + lrank_;
+            const uint64_t tail = r->tail.load(std::memory_order_relaxed);
+            if (tail - r->head.load(std::memory_order_acquire) < RING_SLOTS) {
+                r->slots[tail % RING_SLOTS] = m;
+                r->tail.store(tail + 1, std::memory_order_release);
+                return;
+            }
+            // Ring full (election storm burst): fall through to MPI
+        }
+        MPI_Send(&m, static_cast<int>(sizeof(Message)), MPI_BYTE,
+                 dst_rank - 1, FALLBACK_TAG, comm_);
+    }
+
+    bool try_recv(Message& m) override {
+        // Local rings first, round-robin across senders for fairness
+        for (int i = 0; i < lsize_; ++i) {
+            Ring* r = my_rings_ + (next_src_ + i) % lsize_;
+            const uint64_t head = r->head.load(std::memory_order_relaxed);
+            if (head == r->tail.load(std::memory_order_acquire)) continue;
+            m = r->slots[head % RING_SLOTS];
+            r->head.store(head + 1, std::memory_order_release);
+            next_src_ = static_cast<int>((r - my_rings_) + 1) % lsize_;
+            return true;
+        }
+
+        // Cross-host and overflow traffic
+        MPI_Status status;
+        int flag = 0;
+        MPI_Iprobe(MPI_ANY_SOURCE, FALLBACK_TAG, comm_, &flag, &status);
+        if (!flag) return false;
+        MPI_Recv(&m, static_cast<int>(sizeof(Message)), MPI_BYTE,
+                 status.MPI_SOURCE, FALLBACK_TAG, comm_, MPI_STATUS_IGNORE);
+        return true;
+    }
+
+    void reset() override {
+        Message discard{};
+        while (try_recv(discard)) {}
+    }
+
+private:
+    // One cache line for each counter so producer and consumer do not
+    // false-share; the 24-byte Message keeps a slot within half a line
+    struct alignas(64) Ring {
+        std::atomic<uint64_t> head;
+        char pad0[64 - sizeof(std::atomic<uint64_t>)];
+        std::atomic<uint64_t> tail;
+        char pad1[64 - sizeof(std::atomic<uint64_t>)];
+        Message slots[RING_SLOTS];
+    };
+
+    MPI_Comm comm_;
+    MPI_Comm shm_comm_ = MPI_COMM_NULL;
+    MPI_Win win_ = MPI_WIN_NULL;
+    int num_nodes_;
+    int wrank_ = 0;
+    int lrank_ = 0;
+    int lsize_ = 0;
+    int next_src_ = 0;
+    std::vector<int> local_of_;    // worker rank -> local rank (-1 remote)
+    std::vector<Ring*> peer_base_;
+    Ring* my_rings_ = nullptr;
+};
+
+// Shared mailbox for the in-process engine: one FIFO inbox per rank
+// (index 0 is unused - it belongs to the controller).
+class InprocRouter {
+public:
+    explicit InprocRouter(int world_size) : inboxes_(world_size) {}
+
+    void post(const Message& m, int dst_rank) {
+        inboxes_[dst_rank].push_back(m);
+    }
+
+    bool take(int rank, Message& m) {
+        auto& q = inboxes_[rank];
+        if (q.empty()) return false;
+        m = q.front();
+        q.pop_front();
+        return true;
+    }
+
+private:
+    std::vector<std::deque<Message>> inboxes_;
+};
+
+// In-process transport: all nodes live in one process and exchange
+// messages through the router's in-memory queues. Used by the
+// "inproc" engine for fast parameter sweeps without MPI launch cost.
+class InprocTransport : public Transport {
+public:
+    InprocTransport(InprocRouter& router, int rank)
+        : router_(router), rank_(rank) {}
+
+    void send(const Message& m, int dst_rank) override {
+        router_.post(m, dst_rank);
+    }
+
+    bool try_recv(Message& m) override {
+        return router_.take(rank_, m);
+    }
+
+private:
+    InprocRouter& router_;
+    int rank_;
+};
@@ -1,6 +1,9 @@
 // main.js - Main application logic
 
 class BullyVisualizer {
+    // Live mode keeps at most this many recent ticks in memory
+    static LIVE_WINDOW_TICKS = 5000;
+
     constructor() {
         this.parser = new LogParser();
         this.graph = null;
@@ -163,6 +166,78 @@ class BullyVisualizer {
         }
     }
 
+    // Live mode: poll the server's /tail endpoint for bytes appended to
+    // each log since the last poll and feed complete lines to the
+    // parser, so the timeline grows while the simulation is running.
+    // Old ticks are pruned past LIVE_WINDOW_TICKS to bound memory.
+    startLiveTail(stateFile, messageFile, debugFile) {
+        this.liveFiles = [
+            { file: stateFile, offset: 0, partial: '', parse: (t) => this.parser.parseStateLogs(t) },
+            { file: messageFile, offset: 0, partial: '', parse: (t) => this.parser.parseMessageLogs(t) }
+        ];
+        if (debugFile) {
+            this.liveFiles.push({ file: debugFile, offset: 0, partial: '', parse: (t) => this.parser.parseDebugLogs(t) });
+        }
+        this.liveInitialized = false;
+        this.livePolling = false;
+        this.liveTimer = setInterval(() => this.pollLive(), 1000);
+        this.pollLive();
+    }
+
+    async pollLive() {
+        if (this.livePolling) return;  // skip if the last poll is still in flight
+        this.livePolling = true;
+        let grew = false;
+
+        for (const f of this.liveFiles) {
+            try {
+                const resp = await fetch(`tail?file=${f.file}&offset=${f.offset}`);
+                if (!resp.ok) continue;
+                const buf = await resp.arrayBuffer();
+                if (buf.byteLength === 0) continue;
+                f.offset += buf.byteLength;
+
+                // Only hand complete lines to the parser; a line cut
+                // mid-write is buffered until the rest arrives
+                const text = f.partial + new TextDecoder().decode(buf);
+                const lastNewline = text.lastIndexOf('\n');
+                if (lastNewline < 0) {
+                    f.partial = text;
+                    continue;
+                }
+                f.partial = text.slice(lastNewline + 1);
+                f.parse(text.slice(0, lastNewline + 1));
+                grew = true;
+            } catch (e) {
+                // Server restarting or stream not connected yet; retry next poll
+            }
+        }
+        this.livePolling = false;
+        if (!grew) return;
+
+        const newMax = this.parser.getMaxTick();
+        this.parser.pruneBelow(newMax - BullyVisualizer.LIVE_WINDOW_TICKS);
+
+        if (!this.liveInitialized) {
+            if (this.parser.getNodeUIDs().length === 0) return;
+            this.stateFileLoaded = true;
+            this.msgFileLoaded = true;
+            this.initializeVisualization();
+            this.goToTick(this.maxTick);  // jump to the live edge
+            this.liveInitialized = true;
+            return;
+        }
+
+        if (newMax > this.maxTick) {
+            // Follow the live edge unless the user scrubbed back
+            const follow = this.currentTick === this.maxTick;
+            this.maxTick = newMax;
+            document.getElementById('tick-slider').max = newMax;
+            this.timeline.init(this.parser.getNodeUIDs(), newMax);
+            this.goToTick(follow ? newMax : this.currentTick);
+        }
+    }
+
     initializeVisualization() {
         const metadata = this.parser.getMetadata();
         const nodeUIDs = this.parser.getNodeUIDs();
@@ -339,7 +414,10 @@ document.addEventListener('DOMContentLoaded', () => {
     fetch('autoload.json')
         .then(response => response.json())
         .then(config => {
-            if (config.autoload && config.stateFile && config.messageFile) {
+            if (config.live && config.stateFile && config.messageFile) {
+                console.log('Live mode: tailing log files...');
+                window.visualizer.startLiveTail(config.stateFile, config.messageFile, config.debugFile);
+            } else if (config.autoload && config.stateFile && config.messageFile) {
                 console.log('Auto-loading log files...');
                 window.visualizer.autoLoadFiles(config.stateFile, config.messageFile, config.debugFile);
             }
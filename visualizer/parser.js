@@ -106,12 +106,28 @@ class LogParser {
         return this.maxTick;
     }
 
-    // Get unique node UIDs from first tick
+    // Get unique node UIDs from the earliest tick present (tick 0
+    // normally; later when attached to a live stream mid-run)
     getNodeUIDs() {
-        const firstState = this.statesByTick.get(0);
+        let firstState = this.statesByTick.get(0);
+        if (!firstState && this.statesByTick.size > 0) {
+            const firstTick = Math.min(...this.statesByTick.keys());
+            firstState = this.statesByTick.get(firstTick);
+        }
         if (!firstState) return [];
         return firstState.map(n => n.uid).sort((a, b) => a - b);
     }
+
+    // Drop per-tick data older than the given tick; live mode calls
+    // this to keep memory bounded on long runs (pruned ticks render
+    // as empty when scrubbed back to)
+    pruneBelow(tick) {
+        for (const map of [this.statesByTick, this.messagesByTick, this.debugByTick]) {
+            for (const t of map.keys()) {
+                if (t < tick) map.delete(t);
+            }
+        }
+    }
 }
 
 // Export for use in other modules
@@ -4,20 +4,39 @@ Simple HTTP server for the Bully Election Visualizer.
 
 Usage:
     python serve.py --state path/to/state_log.jsonl --msg path/to/message_log.jsonl --debug path/to/debug_log.jsonl [--port PORT]
+    python serve.py --live 9700 [--port PORT]
 
 If log files are provided, they will be copied to the visualizer directory
 and automatically loaded when the page opens.
+
+With --live, the server instead connects to a running simulation's stream
+port (logging.stream_port in the sim config), decodes the length-prefixed
+binary record frames into the usual JSONL log files as they arrive, and
+the page tails those files so the timeline grows while the run is still
+going. Attaching mid-run works; the view starts at the current tick.
 """
 
 import http.server
 import socketserver
 import os
 import shutil
+import socket
+import struct
+import threading
+import time
 import argparse
 import webbrowser
 import json
 from pathlib import Path
 
+MSG_TYPE_NAMES = {
+    1: 'HEARTBEAT', 2: 'ELECTION', 3: 'OK', 4: 'COORDINATOR',
+    5: 'PING', 6: 'ACK', 7: 'STATE_REPORT',
+}
+
+# RecordKind values from src/binlog.hpp
+KIND_METADATA, KIND_STATES, KIND_MESSAGES, KIND_DEBUG, KIND_REPLICATION = 1, 2, 3, 4, 5
+
 def parse_args():
     parser = argparse.ArgumentParser(
         description='Serve the Bully Election Visualizer with optional log files'
@@ -48,8 +67,117 @@ def parse_args():
         action='store_true',
         help='Do not open browser automatically'
     )
+    parser.add_argument(
+        '--live',
+        type=int,
+        metavar='STREAM_PORT',
+        help='Relay a running simulation: connect to its stream port '
+             '(logging.stream_port) and tail the records into the page'
+    )
     return parser.parse_args()
 
+
+def recv_exact(sock, n):
+    """Read exactly n bytes, or return None on EOF."""
+    buf = b''
+    while len(buf) < n:
+        chunk = sock.recv(n - len(buf))
+        if not chunk:
+            return None
+        buf += chunk
+    return buf
+
+
+def decode_record(payload, state_file, msg_file, debug_file):
+    """Decode one binary record (RecordHeader + payload, the same structs
+    BinLogWriter puts on disk) and append the equivalent JSONL lines."""
+    kind, count = struct.unpack_from('<ii', payload, 0)
+    body = payload[8:]
+
+    if kind == KIND_METADATA:
+        num_nodes, num_ticks, seed = struct.unpack_from('<iiQ', body, 0)
+        line = {'metadata': True, 'num_nodes': num_nodes,
+                'num_ticks': num_ticks, 'seed': seed}
+        state_file.write(json.dumps(line, separators=(',', ':'), sort_keys=True, ensure_ascii=False) + '\n')
+        state_file.flush()
+
+    elif kind == KIND_STATES:
+        nodes = []
+        tick = 0
+        for i in range(count):
+            tick, uid, online, leader, election, last_hb = \
+                struct.unpack_from('<6i', body, i * 24)
+            nodes.append({'uid': uid, 'online': bool(online),
+                          'leader': leader, 'election': bool(election),
+                          'last_hb': last_hb})
+        line = {'tick': tick, 'nodes': nodes}
+        state_file.write(json.dumps(line, separators=(',', ':'), sort_keys=True, ensure_ascii=False) + '\n')
+        state_file.flush()
+
+    elif kind == KIND_MESSAGES:
+        for i in range(count):
+            tick, mtype, src, dst, dropped, direction, _, _ = \
+                struct.unpack_from('<8i', body, i * 32)
+            line = {'tick': tick,
+                    'type': MSG_TYPE_NAMES.get(mtype, 'UNKNOWN'),
+                    'src': src, 'dst': dst, 'dropped': bool(dropped),
+                    'dir': 'send' if direction == 0 else 'recv'}
+            msg_file.write(json.dumps(line, separators=(',', ':'), sort_keys=True, ensure_ascii=False) + '\n')
+        msg_file.flush()
+
+    elif kind == KIND_DEBUG:
+        off = 0
+        for _ in range(count):
+            tick, uid, length = struct.unpack_from('<3i', body, off)
+            off += 12
+            msg = body[off:off + length].decode('utf-8', errors='replace')
+            off += length
+            line = {'tick': tick, 'uid': uid, 'msg': msg}
+            debug_file.write(json.dumps(line, separators=(',', ':'), sort_keys=True, ensure_ascii=False) + '\n')
+        debug_file.flush()
+
+    elif kind == KIND_REPLICATION:
+        replication, _, seed = struct.unpack_from('<iiQ', body, 0)
+        line = {'metadata': True, 'replication': replication, 'seed': seed}
+        state_file.write(json.dumps(line, separators=(',', ':'), sort_keys=True, ensure_ascii=False) + '\n')
+        state_file.flush()
+
+
+def stream_relay(stream_port, dest_dir):
+    """Background thread: connect to the simulation's stream endpoint
+    (retrying until it comes up) and append decoded records to the log
+    files the page is tailing. The simulation drops a viewer that falls
+    too far behind rather than stalling, so after a disconnect this
+    keeps retrying and reattaches at the current tick."""
+    with open(dest_dir / 'state_log.jsonl', 'w') as state_file, \
+         open(dest_dir / 'message_log.jsonl', 'w') as msg_file, \
+         open(dest_dir / 'debug_log.jsonl', 'w') as debug_file:
+        connected_before = False
+        while True:
+            try:
+                sock = socket.create_connection(('127.0.0.1', stream_port),
+                                                timeout=0.5)
+                sock.settimeout(None)
+            except OSError:
+                time.sleep(0.5)
+                continue
+
+            print(f"Live: {'re' if connected_before else ''}connected "
+                  f"to simulation on port {stream_port}")
+            connected_before = True
+            while True:
+                prefix = recv_exact(sock, 4)
+                if prefix is None:
+                    break
+                (length,) = struct.unpack('<I', prefix)
+                payload = recv_exact(sock, length)
+                if payload is None:
+                    break
+                decode_record(payload, state_file, msg_file, debug_file)
+            sock.close()
+            print("Live: stream closed (run finished, or we fell behind; "
+                  "will reattach if the port comes back)")
+
 def copy_log_files(state_log, message_log, debug_log, dest_dir):
     """Copy log files to the visualizer directory."""
     copied = []
@@ -86,10 +214,11 @@ def copy_log_files(state_log, message_log, debug_log, dest_dir):
 
     return copied
 
-def create_autoload_config(dest_dir, has_state, has_message, has_debug):
+def create_autoload_config(dest_dir, has_state, has_message, has_debug, live=False):
     """Create a config file that tells the frontend to auto-load files."""
     config = {
         'autoload': has_state and has_message,
+        'live': live,
         'stateFile': 'state_log.jsonl' if has_state else None,
         'messageFile': 'message_log.jsonl' if has_message else None,
         'debugFile': 'debug_log.jsonl' if has_debug else None
@@ -100,7 +229,35 @@ def create_autoload_config(dest_dir, has_state, has_message, has_debug):
     return config['autoload']
 
 class CORSHandler(http.server.SimpleHTTPRequestHandler):
-    """HTTP handler with CORS headers."""
+    """HTTP handler with CORS headers and a /tail endpoint for live mode."""
+
+    # Log files the page may tail incrementally
+    TAIL_FILES = {'state_log.jsonl', 'message_log.jsonl', 'debug_log.jsonl'}
+
+    def do_GET(self):
+        # /tail?file=state_log.jsonl&offset=N returns the bytes written
+        # past N, so the page only downloads what is new each poll
+        if self.path.startswith('/tail?'):
+            from urllib.parse import parse_qs, urlparse
+            query = parse_qs(urlparse(self.path).query)
+            name = query.get('file', [''])[0]
+            offset = int(query.get('offset', ['0'])[0])
+            if name not in self.TAIL_FILES or offset < 0:
+                self.send_error(400, 'Bad tail request')
+                return
+            try:
+                with open(name, 'rb') as f:
+                    f.seek(offset)
+                    data = f.read()
+            except OSError:
+                data = b''
+            self.send_response(200)
+            self.send_header('Content-Type', 'application/octet-stream')
+            self.send_header('Content-Length', str(len(data)))
+            self.end_headers()
+            self.wfile.write(data)
+            return
+        super().do_GET()
 
     def end_headers(self):
         self.send_header('Access-Control-Allow-Origin', '*')
@@ -124,7 +281,16 @@ def main():
     has_message = False
     has_debug = False
 
-    if args.state_log or args.message_log or args.debug_log:
+    if args.live:
+        # The relay thread fills these as frames arrive; start them
+        # empty so the page never sees a stale run
+        for name in ('state_log.jsonl', 'message_log.jsonl', 'debug_log.jsonl'):
+            (script_dir / name).write_text('')
+        has_state = has_message = has_debug = True
+        relay = threading.Thread(target=stream_relay,
+                                 args=(args.live, script_dir), daemon=True)
+        relay.start()
+    elif args.state_log or args.message_log or args.debug_log:
         copied = copy_log_files(args.state_log, args.message_log, args.debug_log, script_dir)
         has_state = any(t == 'state' for t, _ in copied)
         has_message = any(t == 'message' for t, _ in copied)
@@ -136,7 +302,8 @@ def main():
         has_debug = (script_dir / 'debug_log.jsonl').exists()
 
     # Create autoload config
-    autoload = create_autoload_config(script_dir, has_state, has_message, has_debug)
+    autoload = create_autoload_config(script_dir, has_state, has_message,
+                                      has_debug, live=bool(args.live))
 
     print()
     print(f"Starting Bully Election Visualizer")
@@ -146,6 +313,8 @@ def main():
     print(f"Message log: {'Ready' if has_message else 'Not found'}")
     print(f"Debug log: {'Ready' if has_debug else 'Not found'}")
     print(f"Auto-load: {'Yes' if autoload else 'No (upload files manually)'}")
+    if args.live:
+        print(f"Live: relaying stream port {args.live}")
     print()
     print("Press Ctrl+C to stop")
     print()